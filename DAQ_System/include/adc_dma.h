@@ -0,0 +1,115 @@
+// adc_dma.h
+// Continuous-mode ADC sampling backend (ESP32 ADC digital controller + DMA).
+// The hardware scans the profile's ADC_PINS round-robin into DMA buffers at a
+// multiple of the profile rate; adcDmaRead() low-pass filters and decimates
+// each channel (fir_decimator.h) into AdcRow entries for the packer.
+
+#ifndef ADC_DMA_H
+#define ADC_DMA_H
+
+#include "control.h"
+#include "daq_config.h"
+#include "profiles.h"
+
+// ESP32 continuous mode cannot scan slower than 20kHz in total. Every profile
+// is scanned at adcDmaOversample() x its rate (at least ADC_DMA_MIN_OVERSAMPLE,
+// so the decimator has room for its transition band) and decimated back.
+constexpr uint32_t ADC_DMA_MIN_SCAN_HZ = 20000;
+constexpr uint32_t ADC_DMA_MIN_OVERSAMPLE = 8;
+
+// Decimator length in output samples; taps = ADC_FIR_TAPS_PER_PHASE x oversample.
+// Hamming at 8: flat to ~0.3 x ADC rate, >50dB down above 0.75 x ADC rate.
+constexpr size_t ADC_FIR_TAPS_PER_PHASE = 8;
+
+constexpr uint32_t adcDmaOversample(const ProfileInfo& p) {
+  const uint32_t n = (ADC_DMA_MIN_SCAN_HZ + p.adcHz * p.adcCh - 1) / (p.adcHz * p.adcCh);
+  return n > ADC_DMA_MIN_OVERSAMPLE ? n : ADC_DMA_MIN_OVERSAMPLE;
+}
+constexpr uint32_t adcDmaScanHz(const ProfileInfo& p) {
+  return p.adcHz * p.adcCh * adcDmaOversample(p);
+}
+
+// Rows per DMA conversion frame: one FramePacket's worth, or with DAQ_CONTROL
+// at most CONTROL_DMA_FRAME_US of them (at least one row), so rows reach the
+// control path sooner at the cost of more conversion-done interrupts.
+constexpr size_t adcDmaFrameRows(const ProfileInfo& p) {
+#if DAQ_CONTROL
+  const size_t rows = (size_t)(((uint64_t)CONTROL_DMA_FRAME_US * p.adcHz) / 1000000u);
+  return rows < 1 ? 1 : (rows > p.adcBlock ? p.adcBlock : rows);
+#else
+  return p.adcBlock;
+#endif
+}
+
+// Decimator group delay: each output describes the middle of its filter
+// window, (taps - 1) / 2 input samples before its last input.
+constexpr uint32_t adcDmaFirDelayUs(const ProfileInfo& p) {
+  return (uint32_t)(((uint64_t)(ADC_FIR_TAPS_PER_PHASE * adcDmaOversample(p) - 1) * (1000000u / p.adcHz)) /
+                    (2 * adcDmaOversample(p)));
+}
+
+// Oldest row's age (now - t_us) when adcDmaRead() returns its frame: the DMA
+// frame plus the group delay. This is the DMA backend's sample-to-control delay.
+constexpr uint32_t adcDmaRowAgeUs(const ProfileInfo& p) {
+  return (uint32_t)adcDmaFrameRows(p) * (1000000u / p.adcHz) + adcDmaFirDelayUs(p);
+}
+
+constexpr size_t adcDmaFrameResults(const ProfileInfo& p) {
+  return adcDmaFrameRows(p) * adcDmaOversample(p) * p.adcCh;
+}
+
+constexpr size_t adcDmaMaxFrameResults() {
+  size_t m = 0;
+  for (size_t i = 0; i < PROFILE_COUNT; i++) {
+    if (adcDmaFrameResults(PROFILES[i]) > m) m = adcDmaFrameResults(PROFILES[i]);
+  }
+  return m;
+}
+
+constexpr bool adcDmaProfilesFit() {
+  for (size_t i = 0; i < PROFILE_COUNT; i++) {
+    if (adcDmaScanHz(PROFILES[i]) > 2000000) return false;
+  }
+  return true;
+}
+
+constexpr uint32_t adcDmaMaxOversample() {
+  uint32_t m = 0;
+  for (size_t i = 0; i < PROFILE_COUNT; i++) {
+    if (adcDmaOversample(PROFILES[i]) > m) m = adcDmaOversample(PROFILES[i]);
+  }
+  return m;
+}
+
+constexpr size_t ADC_DMA_MAX_ROWS_PER_FRAME = PROFILE_MAX_BLOCK;
+constexpr size_t ADC_FIR_MAX_TAPS = ADC_FIR_TAPS_PER_PHASE * adcDmaMaxOversample();
+constexpr size_t ADC_DMA_MAX_FRAME_RESULTS = adcDmaMaxFrameResults();
+constexpr size_t ADC_DMA_FRAMES_BUFFERED = 4; // driver ring, in FramePacket periods: >= double buffering
+
+static_assert(adcDmaProfilesFit(), "a profile's ADC rate x channels exceeds the ESP32 ADC DMA limit");
+static_assert(!DAQ_CONTROL || adcDmaRowAgeUs(PROFILES[PROFILE_EMG]) < CONTROL_TARGET_US,
+              "DMA EMG profile no longer meets the control latency target");
+
+// Configure the pattern table and decimator for the profile and start
+// conversions. Stops and releases a previous configuration first (profile switch).
+bool adcDmaBegin(ProfileId id);
+
+// What happened in the driver since the previous adcDmaRead().
+struct AdcDmaReadInfo {
+  uint32_t lostRows;   // rows of frames the driver dropped (its ring was full); they precede these rows
+  uint32_t lagFrames;  // whole frames already converted and still queued behind these rows
+};
+
+// Block until the next DMA frame is complete, then decode it into rows.
+// Fills t_us and adc[] of up to maxRows rows (idx and profile are left to the
+// caller). t_us is the centre of each row's filter window, i.e. it already
+// accounts for the decimator's group delay. Returns the number of rows
+// written; 0 on timeout. The caller advances its sample index by
+// info.lostRows before these rows, so the gap stays visible downstream.
+size_t adcDmaRead(AdcRow* rows, size_t maxRows, uint32_t timeoutMs, AdcDmaReadInfo& info);
+
+// Results discarded while resynchronising to the start of a scan, or lost
+// with the frames the driver dropped.
+uint32_t adcDmaDroppedResults();
+
+#endif // ADC_DMA_H
@@ -0,0 +1,41 @@
+// adc_spi.h
+// External ADC backend (DAQ_ADC_SPI): an AD7606 in serial mode on VSPI, 8
+// channels sampled simultaneously (one CONVST for all of them). adcTask stays
+// timer paced as with analogRead: each T1 tick starts a conversion, waits for
+// BUSY to fall (~4us without oversampling) and clocks the 8 results out of
+// DOUTA in one 16-byte transfer.
+//
+// The AD7606 codes are 16-bit two's complement (+-5V or +-10V, RANGE pin).
+// They are mapped to the 12-bit offset-binary counts (2048 = 0V) the rest of
+// the pipeline works in, so the frame codec and the host scaling are the
+// same for either ADC.
+
+#ifndef ADC_SPI_H
+#define ADC_SPI_H
+
+#include <stdint.h>
+
+#include "daq_config.h"
+
+constexpr int      ADC_SPI_SCLK   = 18;     // VSPI defaults
+constexpr int      ADC_SPI_MISO   = 19;     // DOUTA
+constexpr int      ADC_SPI_CS     = 5;
+constexpr int      ADC_SPI_CONVST = 4;      // CONVST A and B tied
+constexpr int      ADC_SPI_BUSY   = 16;
+constexpr int      ADC_SPI_RESET  = 17;
+constexpr uint32_t ADC_SPI_HZ     = 20000000; // serial SCLK, AD7606 max 23.5MHz
+constexpr uint32_t ADC_SPI_BUSY_TIMEOUT_US = 20;
+constexpr unsigned ADC_SPI_SHIFT  = 4;       // 16-bit code -> 12-bit count
+
+#if DAQ_ADC_SPI
+static_assert(ADC_CH == 8, "the AD7606 has 8 inputs");
+
+// Pins, SPI bus and a reset pulse. Call once from setup().
+bool adcSpiBegin();
+
+// Convert and read all ADC_CH channels into adc[] (adcTask context). Returns
+// false, adc[] untouched, if the converter does not finish in time.
+bool adcSpiRead(uint16_t adc[ADC_CH]);
+#endif
+
+#endif // ADC_SPI_H
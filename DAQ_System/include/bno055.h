@@ -0,0 +1,38 @@
+// bno055.h
+// Raw BNO055 data reads: ACC, MAG and GYR (registers 0x08-0x19) in one 18-byte
+// I2C burst per device, optionally extended to the fused quaternion (0x20-0x27,
+// fusion modes only) for orientation.h. Values stay in sensor LSBs; Adafruit_BNO055 is only
+// used for bring-up (reset, mode, crystal) in setup().
+
+#ifndef BNO055_H
+#define BNO055_H
+
+#include <Wire.h>
+#include <stddef.h>
+#include <stdint.h>
+
+constexpr uint8_t BNO055_ACC_DATA_X_LSB = 0x08; // start of ACC, MAG, GYR block
+constexpr size_t  BNO055_AMG_BYTES      = 18;   // 3 vectors x 3 axes x int16
+constexpr uint8_t BNO055_QUA_DATA_W_LSB = 0x20; // quaternion w, x, y, z
+constexpr size_t  BNO055_AMGQ_BYTES     = BNO055_QUA_DATA_W_LSB + 8 - BNO055_ACC_DATA_X_LSB; // 32, Euler included
+
+// Register order is ACC, MAG, GYR; the frame order (acc, gyro, mag) is applied
+// by the caller.
+struct Bno055Raw {
+  int16_t acc[3];
+  int16_t mag[3];
+  int16_t gyr[3];
+};
+
+// Burst-read the ACC/MAG/GYR block. Returns false (and leaves out untouched)
+// if the device NAKs or returns short.
+bool bno055ReadAmg(TwoWire& wire, uint8_t addr, Bno055Raw& out);
+
+// Same burst, continued through the quaternion registers (w, x, y, z in
+// ORIENT_QUAT_ONE units); the Euler angles in between are read and dropped.
+bool bno055ReadAmgQuat(TwoWire& wire, uint8_t addr, Bno055Raw& out, int16_t quat[4]);
+
+// TCA9548A I2C mux (imu_array.h, DAQ_IMU_MUX): route the bus to channel only.
+bool tca9548aSelect(TwoWire& wire, uint8_t muxAddr, uint8_t channel);
+
+#endif // BNO055_H
@@ -1,16 +1,27 @@
 // callbacks.h
 // Declarations for timer callback functions.
-// Keep this header minimal: only the ISR prototypes.
+// Keep this header minimal: only the timer callback prototypes.
 
 #ifndef CALLBACKS_H
 #define CALLBACKS_H
 
 #include <Arduino.h>
 
-// Timer 1 ISR (10 Hz)
+// Timer 1 ISR (ADC_HZ): wakes the ADC sampling task
 extern "C" void IRAM_ATTR T1_callback();
 
-// Timer 2 ISR (5 Hz)
+// Timer 2 ISR (IMU_HZ): queues an IMU tick number
 extern "C" void IRAM_ATTR T2_callback();
 
+// ADC ticks so far; samplingTimersStart() restarts it with the epoch. Other
+// tasks may notify adcTask too, so adcTask counts periods from this.
+extern volatile uint32_t adcTimerTicks;
+
+// Last IMU tick number queued; samplingTimersStart() restarts it with the epoch.
+extern volatile uint32_t imuTimerTicks;
+
+// The same, as esp_timer callbacks (esp_timer task context; sampling_timer.h)
+void T1_task_callback(void* arg);
+void T2_task_callback(void* arg);
+
 #endif // CALLBACKS_H
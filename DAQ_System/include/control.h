@@ -0,0 +1,71 @@
+// control.h
+// Low-latency output for closed-loop control, next to the logging stream.
+// adcTask passes every row it samples, together with the IMU snapshot current
+// at that moment, to controlPublish(): the sample goes into a most-recent-value
+// mailbox (controlLatest) and to the control callback, both in adcTask context
+// (core 1, highest priority). Nothing on this path waits for packerTask,
+// txQueue or the link. The logging stream is built from the same rows, so
+// nothing is read twice.
+//
+// The row reaches the callback before it goes into adcRing. Sample-to-callback
+// delay (now - row.t_us) is whatever the sampler takes to hand the row over:
+//   analogRead / SPI    the timer tick that read it: tens of us, every profile
+//   DMA (the default)   one DMA frame (at most CONTROL_DMA_FRAME_US, but at
+//                       least one row) plus the decimator's group delay, about
+//                       4 output samples: adcDmaRowAgeUs(), ~2ms in EMG, ~10ms
+//                       in balanced, ~50ms in low_power
+// So the CONTROL_TARGET_US target holds in every profile only on a timer paced
+// backend: build with DAQ_CONTROL=1 DAQ_ADC_DMA=0 (analogRead) or
+// DAQ_CONTROL=1 DAQ_ADC_SPI=1. With DMA it holds in the EMG profile only
+// (checked in adc_dma.h). The row's t_us is its sampling time, so the callback
+// can tell the age.
+
+#ifndef CONTROL_H
+#define CONTROL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "daq_config.h"
+
+// 1 = adcTask publishes rows to the control path (and the DMA backend delivers
+// them in CONTROL_DMA_FRAME_US frames instead of one per FramePacket).
+#ifndef DAQ_CONTROL
+#define DAQ_CONTROL 0
+#endif
+
+constexpr uint32_t CONTROL_DMA_FRAME_US = 1000;
+constexpr uint32_t CONTROL_TARGET_US    = 2000; // sample-to-callback goal
+
+struct ControlSample {
+  AdcRow      row;             // idx and profile filled in
+  ImuSnapshot imu;             // imuCache at the time the row was handed over
+  uint32_t    imuSeq;          // its publication count
+};
+
+// Runs in adcTask for every row, inside the STAGE_ADC_TICK measurement. Must
+// not block; its time adds to every row, so keep it well inside one ADC
+// period of the active profile.
+using ControlCallback = void (*)(const ControlSample& s);
+
+#if DAQ_CONTROL
+
+// Install (or, with nullptr, remove) the callback. Any task, at any time.
+void controlSetCallback(ControlCallback cb);
+
+// Newest sample (any task, wait-free). Returns the number of samples
+// published so far, 0 (out untouched) before the first.
+uint32_t controlLatest(ControlSample& out);
+
+// adcTask only.
+void controlPublish(const AdcRow& row, const ImuSnapshot& imu, uint32_t imuSeq);
+
+#else
+
+inline void controlSetCallback(ControlCallback) {}
+inline uint32_t controlLatest(ControlSample&) { return 0; }
+inline void controlPublish(const AdcRow&, const ImuSnapshot&, uint32_t) {}
+
+#endif // DAQ_CONTROL
+
+#endif // CONTROL_H
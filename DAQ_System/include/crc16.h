@@ -0,0 +1,65 @@
+// crc16.h
+// Table-driven CRC16-CCITT (poly 0x1021, init 0xFFFF, no reflection, no xorout).
+// Bit-exact with the original bitwise CCITT-FALSE loop and DataLogger._crc16_ccitt,
+// but costs one table lookup per byte instead of 8 shift/branch steps.
+
+#ifndef CRC16_H
+#define CRC16_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+constexpr uint16_t CRC16_POLY = 0x1021;
+constexpr uint16_t CRC16_INIT = 0xFFFF;
+
+// 256-entry MSB-first lookup table, built at compile time (no init call, no
+// hand-copied constants). The single instance lives in DRAM, see crc16.cpp.
+struct Crc16Table {
+  uint16_t v[256];
+
+  constexpr Crc16Table() : v() {
+    for (int i = 0; i < 256; i++) {
+      uint16_t crc = (uint16_t)(i << 8);
+      for (int b = 0; b < 8; b++) {
+        crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ CRC16_POLY) : (uint16_t)(crc << 1);
+      }
+      v[i] = crc;
+    }
+  }
+
+  inline uint16_t operator[](uint8_t i) const { return v[i]; }
+};
+
+extern const Crc16Table CRC16_TABLE;
+
+// Incremental CRC state: update() can be called field by field while a packet
+// is being filled in, value() gives the final checksum.
+struct Crc16 {
+  uint16_t crc = CRC16_INIT;
+
+  inline void reset() { crc = CRC16_INIT; }
+
+  inline void update(uint8_t b) {
+    crc = (uint16_t)((crc << 8) ^ CRC16_TABLE[(uint8_t)(crc >> 8) ^ b]);
+  }
+
+  inline void update(const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    uint16_t c = crc;
+    for (size_t i = 0; i < len; i++) {
+      c = (uint16_t)((c << 8) ^ CRC16_TABLE[(uint8_t)(c >> 8) ^ p[i]]);
+    }
+    crc = c;
+  }
+
+  inline uint16_t value() const { return crc; }
+};
+
+// One-shot helper (same signature as the old bitwise version).
+static inline uint16_t crc16_ccitt(const uint8_t* data, size_t len) {
+  Crc16 c;
+  c.update(data, len);
+  return c.value();
+}
+
+#endif // CRC16_H
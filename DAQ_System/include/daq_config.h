@@ -0,0 +1,156 @@
+// daq_config.h
+// Compile-time acquisition config shared by main.cpp and the driver modules.
+// Backend switches are macros so they can be overridden from build_flags.
+
+#ifndef DAQ_CONFIG_H
+#define DAQ_CONFIG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ===================== Backends =====================
+// 1 = external simultaneous-sampling SPI ADC (adc_spi.h) instead of the
+// ESP32's own ADC; adcTask is then timer paced like the analogRead loop.
+#ifndef DAQ_ADC_SPI
+#define DAQ_ADC_SPI 0
+#endif
+
+// Internal ADC: 1 = continuous ADC DMA (adc_dma.cpp), 0 = analogRead() loop in adcTask.
+#ifndef DAQ_ADC_DMA
+#define DAQ_ADC_DMA (!DAQ_ADC_SPI)
+#endif
+
+#if DAQ_ADC_SPI && DAQ_ADC_DMA
+#error "DAQ_ADC_DMA drives the internal ADC and cannot be combined with DAQ_ADC_SPI"
+#endif
+
+// Number of BNO055s (placement: imu_array.h).
+#ifndef DAQ_IMU_COUNT
+#define DAQ_IMU_COUNT 2
+#endif
+
+// Output link used by txTask (transport.cpp).
+#define DAQ_TRANSPORT_UART    1   // ESP-IDF UART driver on UART0 at SERIAL_BAUD
+#define DAQ_TRANSPORT_USB_CDC 2   // native USB CDC (S2/S3/C3...), baud ignored
+#define DAQ_TRANSPORT_UDP     3   // Wi-Fi STA, FramePackets batched into UDP datagrams
+
+#ifndef DAQ_TRANSPORT
+#if defined(ARDUINO_USB_CDC_ON_BOOT) && ARDUINO_USB_CDC_ON_BOOT
+#define DAQ_TRANSPORT DAQ_TRANSPORT_USB_CDC
+#else
+#define DAQ_TRANSPORT DAQ_TRANSPORT_UART
+#endif
+#endif
+
+// 1 = txTask re-codes frames as PKT_TYPE_FRAME_COMPRESSED before sending.
+#ifndef DAQ_TX_COMPRESS
+#define DAQ_TX_COMPRESS 0
+#endif
+
+// What happens to frames the link cannot keep up with (flow_control.h).
+#define DAQ_TX_POLICY_DROP_NEWEST 0   // pool full: drop the frame being built
+#define DAQ_TX_POLICY_DROP_OLDEST 1   // pool full: overwrite the oldest queued frame
+#define DAQ_TX_POLICY_DEGRADE     2   // congested: send ADC-only compressed frames
+#define DAQ_TX_POLICY_DECIMATE    3   // congested: send 1 in 2/4/8 frames by backlog
+
+#ifndef DAQ_TX_POLICY
+#define DAQ_TX_POLICY DAQ_TX_POLICY_DROP_OLDEST
+#endif
+
+// UDP transport target (Wi-Fi STA). Set from build_flags, e.g.
+// -DDAQ_WIFI_SSID=\"lab\" -DDAQ_UDP_HOST=\"192.168.1.20\"
+#ifndef DAQ_WIFI_SSID
+#define DAQ_WIFI_SSID ""
+#endif
+#ifndef DAQ_WIFI_PASS
+#define DAQ_WIFI_PASS ""
+#endif
+#ifndef DAQ_UDP_HOST
+#define DAQ_UDP_HOST "255.255.255.255"   // subnet broadcast unless a host is given
+#endif
+#ifndef DAQ_UDP_PORT
+#define DAQ_UDP_PORT 5005
+#endif
+
+// ===================== Config =====================
+constexpr uint32_t SERIAL_BAUD = 2000000; // UART transport; host bridge must support it
+constexpr uint32_t I2C_HZ      = 400000;
+constexpr int      I2C_SDA_PINS[2] = {21, 25};  // Wire, Wire1 (Wire1 only if an IMU uses it)
+constexpr int      I2C_SCL_PINS[2] = {22, 26};
+
+// Rates and sizes below are the boot profile (PROFILE_BALANCED); the others
+// are in profiles.h. ADC_CH is the number of ADC inputs, the most any profile uses.
+constexpr uint32_t ADC_HZ      = 500;    // ADC sampling rate (per channel)
+constexpr uint32_t IMU_HZ      = 100;    // accel+gyro sampling rate
+constexpr uint32_t MAG_HZ      = 20;     // BNO055 magnetometer output rate (read with every burst)
+
+static_assert((IMU_HZ % MAG_HZ) == 0, "IMU_HZ must be divisible by MAG_HZ");
+static_assert(DAQ_IMU_COUNT >= 1, "at least one IMU");
+
+constexpr uint8_t  ADC_BLOCK   = 5;      // 5 ADC samples per frame (10ms @ 500Hz)
+#if DAQ_ADC_SPI
+constexpr size_t   ADC_CH      = 8;      // AD7606 inputs (adc_spi.h)
+#else
+constexpr size_t   ADC_CH      = 6;      // ADC_PINS
+#endif
+constexpr size_t   IMU_CH_PER  = 9;      // acc(3), gyro(3), mag(3) per IMU
+constexpr size_t   IMU_COUNT   = DAQ_IMU_COUNT;
+constexpr size_t   IMU_CH      = IMU_CH_PER * IMU_COUNT;
+
+constexpr uint16_t SYNC_WORD   = 0xA55A;
+constexpr uint8_t  PKT_VER     = 9;      // 2: FramePacket.imu_seq, 3: imu_dt, 4: profile, 5: gaps, 6: orientation,
+                                          // 7: 32-bit frame_seq, 64-bit frame t_us, 8: frame flags, health stats,
+                                          // 9: recorder stats
+constexpr uint8_t  PKT_TYPE_FRAME = 1;
+constexpr uint8_t  PKT_TYPE_FRAME_COMPRESSED = 2; // frame_codec.h
+constexpr uint8_t  PKT_TYPE_STATS = 3;            // frame_packet.h
+constexpr uint8_t  PKT_TYPE_CMD   = 4;            // host -> device, frame_packet.h
+constexpr uint8_t  PKT_TYPE_GAP   = 5;            // frame_packet.h
+constexpr uint8_t  PKT_TYPE_ORIENTATION = 6;      // orientation.h
+
+constexpr uint32_t STATS_PERIOD_MS = 1000;        // PKT_TYPE_STATS rate
+
+#if !DAQ_ADC_SPI
+// ADC pins (ESP32). All on ADC1, so the DMA scan works with Wi-Fi enabled.
+constexpr int ADC_PINS[ADC_CH] = {36, 39, 34, 35, 32, 33};
+#endif
+
+// Pool depth: 128 frames = 1.28s cushion at 100Hz. Slots are sized for the
+// largest profile frame, which keeps the pool near its old ~29KB of RAM.
+// The queue only carries slot pointers (4 bytes each), so it is sized to never
+// be the limit.
+constexpr size_t TX_POOL_LEN  = 128;
+constexpr size_t TX_QUEUE_LEN = TX_POOL_LEN;
+
+// txQueue backlog (frames) at which txTask treats the link as congested, and
+// below which it is clear again.
+constexpr size_t TX_CONGESTED_DEPTH = TX_QUEUE_LEN / 4;
+constexpr size_t TX_CLEAR_DEPTH     = TX_QUEUE_LEN / 16;
+
+// UART transport driver ring: holds ~70ms of output at 2Mbaud
+constexpr size_t UART_TX_RING_BYTES = 16384;
+
+using sample_t = int16_t;
+
+// ===================== ADC Row =====================
+// One raw ADC sample (all channels) as handed from the sampler to packerTask.
+struct AdcRow {
+  uint32_t t_us;             // micros() when this row was sampled
+  uint32_t idx;              // ADC sample index (restarts at 0 on a profile switch)
+  uint8_t  profile;          // ProfileId the row was sampled under
+  uint8_t  flags;            // FrameFlag bits (frame_packet.h) the row gives its frame
+  uint16_t adc[ADC_CH];      // first Profile::ADC_CH entries are valid
+};
+
+// ===================== IMU Snapshot =====================
+// Latest IMU values, published by imuTask and snapshotted per frame by packerTask.
+// Capture times are micros() at the start of each device's burst; mag has its
+// own time because the sensor updates it at MAG_HZ, slower than we read it.
+struct ImuSnapshot {
+  sample_t v[IMU_CH];
+  uint32_t t_us[IMU_COUNT];     // acc/gyro capture time
+  uint32_t t_mag_us[IMU_COUNT]; // capture time of the burst that saw the mag change
+  uint8_t  flags;               // FrameFlag bits of the burst (FRAME_FLAG_IMU_LATE)
+};
+
+#endif // DAQ_CONFIG_H
@@ -0,0 +1,76 @@
+// dsp_kernels.h
+// Per-block int16 kernels used by the acquisition path, selected at compile
+// time by target: ESP-DSP (PIE / MAC16 assembly on the ESP32-S3) when
+// DAQ_DSP_ESP_DSP is 1, portable scalar loops otherwise. The scalar versions
+// are always available as *Scalar for the benchmark (DAQ_DSP_BENCH).
+//
+// Block copy (AdcRow -> FramePacket.adc) is left to memcpy: a row is 12 bytes,
+// and newlib's memcpy already uses word copies.
+
+#ifndef DSP_KERNELS_H
+#define DSP_KERNELS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef DAQ_DSP_ESP_DSP
+#if defined(CONFIG_IDF_TARGET_ESP32S3) && __has_include(<esp_dsp.h>)
+#define DAQ_DSP_ESP_DSP 1
+#else
+#define DAQ_DSP_ESP_DSP 0
+#endif
+#endif
+
+// 1 = time scalar vs selected kernels once at boot and print to the console.
+#ifndef DAQ_DSP_BENCH
+#define DAQ_DSP_BENCH 0
+#endif
+
+#if DAQ_DSP_ESP_DSP
+#include <esp_dsp.h>
+#endif
+
+// ===================== Scalar =====================
+// Q15 taps x samples over n entries, rounded to the sample scale (>> 15).
+static inline int16_t dspFirQ15Scalar(const int16_t* h, const int16_t* x, size_t n) {
+  int32_t acc = 1 << 14;
+  for (size_t i = 0; i < n; i++) acc += (int32_t)h[i] * x[i];
+  return (int16_t)(acc >> 15);
+}
+
+// out[i] = cur[i] - prev[i]
+static inline void dspDeltaS16Scalar(const int16_t* cur, const int16_t* prev, int16_t* out, size_t n) {
+  for (size_t i = 0; i < n; i++) out[i] = (int16_t)(cur[i] - prev[i]);
+}
+
+// ===================== Selected =====================
+#if DAQ_DSP_ESP_DSP
+// dsps_dotprod_s16 accumulates in 40 bits and returns acc >> 15; its rounding
+// offset may differ from the scalar version by 1 LSB. n must be a multiple of 4.
+static inline int16_t dspFirQ15(const int16_t* h, const int16_t* x, size_t n) {
+  int16_t y;
+  dsps_dotprod_s16(h, x, &y, (int)n, 0);
+  return y;
+}
+
+// Falls back inside ESP-DSP to the non-PIE path for unaligned buffers.
+static inline void dspDeltaS16(const int16_t* cur, const int16_t* prev, int16_t* out, size_t n) {
+  dsps_sub_s16(cur, prev, out, (int)n, 1, 1, 1, 0);
+}
+#else
+static inline int16_t dspFirQ15(const int16_t* h, const int16_t* x, size_t n) {
+  return dspFirQ15Scalar(h, x, n);
+}
+
+static inline void dspDeltaS16(const int16_t* cur, const int16_t* prev, int16_t* out, size_t n) {
+  dspDeltaS16Scalar(cur, prev, out, n);
+}
+#endif
+
+#if DAQ_DSP_BENCH
+// Run each kernel over representative block sizes, check the selected kernel
+// against the scalar one and print cycles per call. Call before the link starts.
+void dspKernelsBenchmark();
+#endif
+
+#endif // DSP_KERNELS_H
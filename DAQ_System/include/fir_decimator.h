@@ -0,0 +1,103 @@
+// fir_decimator.h
+// Fixed-point low-pass FIR decimator for the oversampled ADC stream.
+// Taps are a Hamming-windowed sinc generated at compile time in Q15 with an
+// exact DC gain of 1, so a constant input comes out unchanged. Each channel
+// keeps a doubled history ring, which makes the newest N samples contiguous
+// for the dot product at every output.
+
+#ifndef FIR_DECIMATOR_H
+#define FIR_DECIMATOR_H
+
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dsp_kernels.h"
+
+// ===================== Compile-time design =====================
+namespace fir_detail {
+
+constexpr double PI = 3.14159265358979323846;
+
+// Taylor series after reduction to [-pi, pi]; accurate to ~1e-12 there.
+constexpr double sinRad(double x) {
+  while (x > PI) x -= 2 * PI;
+  while (x < -PI) x += 2 * PI;
+  double term = x, sum = x;
+  for (int k = 1; k < 16; k++) {
+    term *= -x * x / ((2 * k) * (2 * k + 1));
+    sum += term;
+  }
+  return sum;
+}
+
+constexpr double cosRad(double x) { return sinRad(x + PI / 2); }
+
+constexpr double roundHalfAway(double v) {
+  return v >= 0 ? (double)(int64_t)(v + 0.5) : -(double)(int64_t)(-v + 0.5);
+}
+
+} // namespace fir_detail
+
+// N-tap low-pass, cutoff in cycles per input sample (0 < cutoff < 0.5).
+template <size_t N>
+constexpr std::array<int16_t, N> firLowpassQ15(double cutoff) {
+  using namespace fir_detail;
+  double h[N] = {};
+  double sum = 0;
+  for (size_t i = 0; i < N; i++) {
+    const double t = (double)i - (double)(N - 1) / 2;
+    const double sinc = (t == 0) ? 2 * cutoff : sinRad(2 * PI * cutoff * t) / (PI * t);
+    const double window = 0.54 - 0.46 * cosRad(2 * PI * (double)i / (double)(N - 1));
+    h[i] = sinc * window;
+    sum += h[i];
+  }
+
+  std::array<int16_t, N> q = {};
+  int32_t qsum = 0;
+  for (size_t i = 0; i < N; i++) {
+    q[i] = (int16_t)roundHalfAway(h[i] / sum * 32768.0);
+    qsum += q[i];
+  }
+  q[N / 2] = (int16_t)(q[N / 2] + (32768 - qsum)); // rounding residue -> exact unity gain
+  return q;
+}
+
+// Taps for decimation by R: TapsPerPhase output periods long, cut off at the
+// output Nyquist rate.
+template <uint32_t R, size_t TapsPerPhase>
+struct FirDecimatorTaps {
+  static_assert(R >= 1, "decimation factor must be >= 1");
+  static constexpr size_t N = TapsPerPhase * R;
+  static constexpr std::array<int16_t, N> taps = firLowpassQ15<N>(0.5 / R);
+};
+
+// ===================== Runtime =====================
+// One channel. MaxTaps bounds the history; the active length is set by reset().
+template <size_t MaxTaps>
+struct FirDecimator {
+  int16_t  hist[2 * MaxTaps];
+  uint16_t head = 0;         // next write position in [0, len)
+  uint16_t len = 0;
+
+  // Fill the history with x so the first outputs are not a ramp from 0.
+  void reset(size_t taps, int16_t x) {
+    len = (uint16_t)taps;
+    head = 0;
+    for (size_t i = 0; i < 2 * len; i++) hist[i] = x;
+  }
+
+  inline void push(int16_t x) {
+    hist[head] = x;
+    hist[head + len] = x;
+    if (++head == len) head = 0;
+  }
+
+  // Filter output over the newest len samples (oldest first, matching taps[0]),
+  // on the input's scale.
+  inline int16_t output(const int16_t* taps) const {
+    return dspFirQ15(taps, &hist[head], len);
+  }
+};
+
+#endif // FIR_DECIMATOR_H
@@ -0,0 +1,73 @@
+// flow_control.h
+// TX backpressure helpers. DAQ_TX_POLICY (daq_config.h) picks what gives when
+// the link falls behind; whatever is not sent is reported to the host as gap
+// runs (PKT_TYPE_GAP) instead of silently disappearing.
+//
+//   packerTask: pool/queue exhaustion (drop newest, or steal the oldest queued
+//               frame) and recorder preview thinning
+//   txTask:     congestion (txQueue backlog) -> degraded or decimated frames
+
+#ifndef FLOW_CONTROL_H
+#define FLOW_CONTROL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "crc16.h"
+#include "daq_config.h"
+#include "frame_packet.h"
+
+// Consecutive missing frames with one reason and profile.
+struct GapRun {
+  uint32_t firstSeq = 0;
+  uint16_t count = 0;
+  uint32_t firstAdcIdx = 0;
+  uint8_t  profile = 0;
+  uint8_t  reason = 0;
+
+  // Add frame seq to the run. Returns false (run unchanged) if it does not
+  // continue it; the caller then emits the run and starts a new one.
+  bool extend(uint32_t seq, uint32_t adcIdx, uint8_t prof, uint8_t why) {
+    if (count == 0) {
+      firstSeq = seq;
+      firstAdcIdx = adcIdx;
+      profile = prof;
+      reason = why;
+      count = 1;
+      return true;
+    }
+    if (why != reason || prof != profile || seq != firstSeq + count || count == UINT16_MAX) {
+      return false;
+    }
+    count++;
+    return true;
+  }
+};
+
+inline void gapPacketFill(const GapRun& run, GapPacket& g) {
+  g.sync = SYNC_WORD;
+  g.version = PKT_VER;
+  g.type = PKT_TYPE_GAP;
+  g.reason = run.reason;
+  g.profile = run.profile;
+  g.first_seq = run.firstSeq;
+  g.count = run.count;
+  g.first_adc_idx = run.firstAdcIdx;
+  g.crc16 = crc16_ccitt((const uint8_t*)&g, sizeof(GapPacket) - sizeof(g.crc16));
+}
+
+// Congestion with hysteresis on the txQueue backlog.
+inline bool txCongested(size_t depth, bool wasCongested) {
+  return depth >= TX_CONGESTED_DEPTH || (wasCongested && depth > TX_CLEAR_DEPTH);
+}
+
+// DAQ_TX_POLICY_DECIMATE: send 1 in N frames while congested, N = 2/4/8 as
+// the backlog passes 1/4, 1/2, 3/4 of the queue.
+inline uint32_t txDecimation(size_t depth) {
+  if (depth >= TX_QUEUE_LEN * 3 / 4) return 8;
+  if (depth >= TX_QUEUE_LEN / 2) return 4;
+  if (depth >= TX_QUEUE_LEN / 4) return 2;
+  return 1;
+}
+
+#endif // FLOW_CONTROL_H
@@ -0,0 +1,97 @@
+// frame_codec.h
+// PKT_TYPE_FRAME_COMPRESSED encoder: a frame of any profile re-coded with
+// bit-packed, per-block delta ADC samples and only the IMU fields that changed.
+//
+// Layout (little-endian):
+//   CompressedHeader (same first 22 bytes as FramePacketT, + len + imu_mask
+//   + imu_seq + imu_dt)
+//   ADC bitstream, LSB-first, per channel of the profile:
+//     12 bits first sample, 4 bits width w, (Block-1) x w-bit zigzag deltas
+//     padded to a whole byte
+//   int16 imu[i] for every bit i set in imu_mask, in index order
+//   uint16 crc16 over everything before it
+//
+// Omitted IMU fields are unchanged since the previous compressed frame, unless
+// imu_mask bit COMPRESS_IMU_OMITTED_BIT is set: then the frame is a degraded
+// ADC-only frame (DAQ_TX_POLICY_DEGRADE), its IMU values are unknown, and the
+// next frame is a keyframe. Every
+// COMPRESS_KEYFRAME_FRAMES-th frame, and the first frame after a profile
+// switch, carries all fields, so a receiver that lost frames resynchronises
+// within that many frames.
+
+#ifndef FRAME_CODEC_H
+#define FRAME_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "daq_config.h"
+#include "frame_packet.h"
+#include "profiles.h"
+
+constexpr uint32_t COMPRESS_KEYFRAME_FRAMES = 50; // 0.5s @ 100Hz
+
+#pragma pack(push, 1)
+struct CompressedHeader {
+  uint16_t sync;             // 0xA55A
+  uint8_t  version;          // PKT_VER
+  uint8_t  type;             // PKT_TYPE_FRAME_COMPRESSED
+  uint32_t frame_seq;
+  uint64_t t_us;
+  uint32_t adc_base_idx;
+  uint8_t  profile;          // ProfileId
+  uint8_t  flags;            // FramePacket.flags
+  uint8_t  len;              // total packet bytes, header and crc included
+  uint8_t  imu_mask[(IMU_CH + 8) / 8]; // bit i => imu[i] present, plus a spare top bit
+  uint16_t imu_seq;          // FramePacket.imu_seq
+  int16_t  imu_dt[IMU_COUNT][2]; // FramePacket.imu_dt
+};
+#pragma pack(pop)
+
+// Spare top bit of imu_mask: IMU values deliberately left out (degraded frame).
+constexpr uint8_t COMPRESS_IMU_OMITTED_BIT = 8 * sizeof(CompressedHeader::imu_mask) - 1;
+
+static_assert(IMU_CH <= COMPRESS_IMU_OMITTED_BIT, "imu_mask too small");
+
+static_assert(offsetof(CompressedHeader, flags) == FRAME_FLAGS_OFFSET, "host reads flags at offset 21");
+static_assert(offsetof(CompressedHeader, len) == FRAME_FLAGS_OFFSET + 1, "host reads the compressed len at offset 22");
+
+// Worst case: 13-bit deltas on every channel and every IMU field present.
+template <class P>
+constexpr size_t compressedMaxBytes() {
+  return sizeof(CompressedHeader) + (P::ADC_CH * (12 + 4 + (P::ADC_BLOCK - 1) * 13) + 7) / 8 +
+         IMU_CH * sizeof(int16_t) + sizeof(uint16_t);
+}
+
+template <class P>
+constexpr bool compressedFits() {
+  static_assert(compressedMaxBytes<P>() <= sizeof(ProfilePacket<P>), "compressed frame must never be larger");
+  static_assert(compressedMaxBytes<P>() <= 255, "len field is one byte");
+  return true;
+}
+
+static_assert(compressedFits<Profile<PROFILE_BALANCED>>() &&
+              compressedFits<Profile<PROFILE_EMG>>() &&
+              compressedFits<Profile<PROFILE_LOW_POWER>>(), "");
+
+// Never larger than the raw frame, so any txBatch sized for raw frames fits.
+constexpr size_t COMPRESSED_MAX_BYTES = FRAME_MAX_BYTES;
+
+// Keeps the last IMU values sent, so it must see every frame in order.
+class FrameEncoder {
+public:
+  // Encode one frame (a FramePacketT; its profile byte selects the layout) into
+  // out (COMPRESSED_MAX_BYTES available); returns bytes written. omitImu drops
+  // every IMU field and flags the frame as degraded.
+  size_t encode(const uint8_t* frame, uint8_t* out, bool omitImu = false);
+
+private:
+  template <class P>
+  size_t encodeAs(const ProfilePacket<P>& in, uint8_t* out, bool omitImu);
+
+  int16_t  lastImu_[IMU_CH] = {};
+  uint32_t sinceKey_ = COMPRESS_KEYFRAME_FRAMES; // first frame is a keyframe
+  uint8_t  lastProfile_ = 0xFF;
+};
+
+#endif // FRAME_CODEC_H
@@ -0,0 +1,224 @@
+// frame_packet.h
+// Wire format of the FramePacket stream (little-endian, packed).
+// Must stay in sync with DataLogger.PACKET_STRUCT on the host.
+
+#ifndef FRAME_PACKET_H
+#define FRAME_PACKET_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "daq_config.h"
+
+// ===================== Packet =====================
+// imu_dt resolution: int16 x 10us covers +-327ms, enough for a mag sample that
+// is several MAG_HZ periods old. IMU_DT_INVALID means older than that (or none yet).
+constexpr uint32_t IMU_DT_UNIT_US = 10;
+constexpr int16_t  IMU_DT_INVALID = INT16_MIN;
+
+// FramePacket.flags: frames whose samples were not taken on schedule. The
+// sampling tasks detect a deadline miss per wake-up (health.h); the row or IMU
+// snapshot it produced marks every frame that carries it.
+enum FrameFlag : uint8_t {
+  FRAME_FLAG_ADC_LATE = 1 << 0, // a row was read over one period after its tick (t_us is the tick's),
+                                // followed skipped periods, or lost DMA results
+  FRAME_FLAG_IMU_LATE = 1 << 1, // the IMU burst finished over one IMU period after its tick
+};
+
+// One frame of an acquisition profile (profiles.h): Block samples x Ch channels.
+// frame_seq and t_us do not wrap in practice (years at any frame rate), so the
+// host can tell lost, late and duplicate frames apart with one comparison.
+#pragma pack(push, 1)
+template <uint8_t Ch, uint8_t Block>
+struct FramePacketT {
+  uint16_t sync;             // 0xA55A
+  uint8_t  version;          // PKT_VER
+  uint8_t  type;             // 1 = FramePacket
+  uint32_t frame_seq;        // increments per frame
+  uint64_t t_us;             // device time (us since boot) of the first sample
+  uint32_t adc_base_idx;     // index of first ADC sample in this frame (ADC rate counter)
+  uint8_t  profile;          // ProfileId; tells the host Ch and Block
+  uint8_t  flags;            // FrameFlag bits
+
+  uint16_t adc[Block][Ch];   // Block x Ch ADC samples
+
+  int16_t  imu[IMU_CH];      // per IMU: acc/gyro/mag scaled by 100 (cached)
+  uint16_t imu_seq;          // IMU publication count; repeats if imu[] is unchanged
+  int16_t  imu_dt[IMU_COUNT][2]; // per IMU: acc/gyro, mag capture time - t_us (IMU_DT_UNIT_US)
+
+  uint16_t crc16;            // CRC16-CCITT over all bytes except this field
+};
+#pragma pack(pop)
+
+// Default (PROFILE_BALANCED) layout: 5x6 samples.
+using FramePacket = FramePacketT<ADC_CH, ADC_BLOCK>;
+
+constexpr size_t FRAME_PROFILE_OFFSET = 20;
+constexpr size_t FRAME_FLAGS_OFFSET   = 21;
+
+// Wire size of a Block x Ch frame; DataLogger derives the same layout from
+// ADC_CH / IMU_COUNT.
+constexpr size_t framePacketBytes(size_t ch, size_t block) {
+  return FRAME_FLAGS_OFFSET + 1 + 2 * ch * block + 2 * IMU_CH + 2 + 4 * IMU_COUNT + 2;
+}
+
+static_assert(sizeof(FramePacket) == framePacketBytes(ADC_CH, ADC_BLOCK), "FramePacket must be packed");
+static_assert(ADC_CH != 6 || IMU_COUNT != 2 || sizeof(FramePacket) == 130, "default FramePacket is 130 bytes");
+static_assert(offsetof(FramePacket, profile) == FRAME_PROFILE_OFFSET, "host reads profile at offset 20");
+static_assert(offsetof(FramePacket, flags) == FRAME_FLAGS_OFFSET, "host reads flags at offset 21");
+static_assert(offsetof(FramePacket, crc16) == sizeof(FramePacket) - sizeof(uint16_t),
+              "crc16 must be the last field");
+
+// ===================== Stats Packet =====================
+// PKT_TYPE_STATS, sent by txTask every STATS_PERIOD_MS. Each stage summarises
+// the previous period; all times are nanoseconds.
+enum StatsStageId : uint8_t {
+  STAGE_ADC_TICK = 0,        // adcTask work per wake-up (one row, or one DMA frame)
+  STAGE_PACK,                // packerTask: header + IMU snapshot + CRC + enqueue
+  STAGE_IMU_READ,            // imuTask: I2C reads for one IMU tick
+  STAGE_TX_QUEUE_WAIT,       // time a frame sat in txQueue
+  STAGE_TX_WRITE,            // one transport write (the whole burst)
+  STAGE_SAMPLE_TO_WIRE,      // first sample of a frame -> handed to the link
+  STAGE_ADC_WAKE,            // sample clock alarm -> adcTask running (timer backends; light-sleep exit included)
+  STATS_STAGES
+};
+
+// Tasks whose stack high-water mark is reported (health.h).
+enum StatsTaskId : uint8_t {
+  TASK_ADC = 0,
+  TASK_PACKER,
+  TASK_IMU,
+  TASK_IMU_BUS,              // DAQ_IMU_PARALLEL only
+  TASK_TX,
+  TASK_RX,
+  STATS_TASKS
+};
+
+constexpr uint16_t STATS_STACK_UNKNOWN = 0xFFFF; // stack_free of a task that is not running
+
+#pragma pack(push, 1)
+struct StatsStage {
+  uint32_t count;
+  uint32_t min_ns;
+  uint32_t mean_ns;
+  uint32_t p99_ns;
+  uint32_t max_ns;
+};
+
+struct StatsPacket {
+  uint16_t sync;             // 0xA55A
+  uint8_t  version;          // PKT_VER
+  uint8_t  type;             // PKT_TYPE_STATS
+  uint16_t stats_seq;        // increments per stats packet
+  uint32_t t_us;             // micros() when built
+  uint8_t  len;              // sizeof(StatsPacket)
+  uint8_t  stage_count;      // STATS_STAGES
+
+  StatsStage stage[STATS_STAGES];
+
+  uint16_t tx_queue_hwm;     // peak txQueue depth (frames), since boot
+  uint16_t tx_pool_min_free; // lowest free txPool slot count, since boot
+  uint16_t adc_ring_hwm;     // peak adcRing fill (rows), since boot
+  uint8_t  profile;          // active ProfileId
+  uint8_t  reset_reason;     // esp_reset_reason() of this boot (e.g. ESP_RST_TASK_WDT)
+
+  uint32_t dropped_tx_packets;
+  uint32_t dropped_adc_rows;
+  uint32_t adc_dma_dropped;  // DMA results discarded while resyncing
+
+  uint32_t link_bytes;       // TransportStats of the active link
+  uint32_t link_short_writes;
+  uint32_t link_max_write_us;
+  uint32_t link_tx_hwm;
+
+  uint32_t adc_deadline_misses; // adcTask wake-ups that missed their deadline, since boot
+  uint32_t adc_last_miss_us;    // micros() of the latest, 0 = none yet
+  uint32_t imu_deadline_misses; // the same for imuTask
+  uint32_t imu_last_miss_us;
+
+  uint32_t record_blocks;       // RecorderStats (recorder.h), 0 without DAQ_RECORD
+  uint32_t record_write_errors;
+  uint32_t record_max_write_us;
+  uint32_t record_dropped_frames; // sent on the link instead of recorded
+
+  uint16_t stack_free[STATS_TASKS]; // least free stack per task since boot, bytes
+
+  uint16_t crc16;            // CRC16-CCITT over all bytes except this field
+};
+#pragma pack(pop)
+
+static_assert(sizeof(StatsPacket) <= 255, "StatsPacket len field is one byte");
+static_assert(offsetof(StatsPacket, len) == 10, "host reads StatsPacket.len at offset 10");
+
+// ===================== Gap Packet =====================
+// PKT_TYPE_GAP: a run of consecutive frame_seq values the device built but
+// will never send, so the host can tell device-side drops from link loss.
+// Sent ahead of the frames that follow the run.
+enum GapReason : uint8_t {
+  GAP_TX_FULL      = 1,      // no pool slot / queue space: the new frame was dropped
+  GAP_DROP_OLDEST  = 2,      // DAQ_TX_POLICY_DROP_OLDEST: queued frame overwritten
+  GAP_DECIMATED    = 3,      // DAQ_TX_POLICY_DECIMATE: skipped while congested
+  GAP_RECORDED     = 4,      // recorder preview: frame is on the recording only
+};
+
+#pragma pack(push, 1)
+struct GapPacket {
+  uint16_t sync;             // 0xA55A
+  uint8_t  version;          // PKT_VER
+  uint8_t  type;             // PKT_TYPE_GAP
+  uint8_t  reason;           // GapReason
+  uint8_t  profile;          // ProfileId of the missing frames
+  uint32_t first_seq;        // frame_seq of the first missing frame
+  uint16_t count;            // consecutive frames missing
+  uint32_t first_adc_idx;    // adc_base_idx of the first missing frame
+  uint16_t crc16;            // CRC16-CCITT over all bytes except this field
+};
+#pragma pack(pop)
+
+static_assert(sizeof(GapPacket) == 18, "GapPacket size must be 18 bytes");
+
+// ===================== Orientation Packet =====================
+// PKT_TYPE_ORIENTATION (orientation.h, DAQ_ORIENTATION): the BNO055 fused
+// orientation of each IMU, one packet per IMU sample.
+constexpr int16_t ORIENT_QUAT_ONE      = 1 << 14; // BNO055 quaternion LSBs per 1.0
+constexpr int16_t ORIENT_JOINT_INVALID = INT16_MIN;
+
+#pragma pack(push, 1)
+struct OrientationPacket {
+  uint16_t sync;             // 0xA55A
+  uint8_t  version;          // PKT_VER
+  uint8_t  type;             // PKT_TYPE_ORIENTATION
+  uint16_t orient_seq;       // increments per packet
+  uint16_t imu_seq;          // imuCache publication of the same burst (FramePacket.imu_seq)
+  uint32_t t_us;             // capture time of IMU 0's burst
+  int16_t  quat[IMU_COUNT][4]; // w, x, y, z per IMU, ORIENT_QUAT_ONE = 1.0
+  int16_t  joint_cdeg;       // IMU 1 relative to IMU 0 about JOINT_AXIS, 0.01 deg
+  uint8_t  valid;            // bit d: quat[d] read this burst, fusion running
+  uint8_t  reserved;
+  uint16_t crc16;            // CRC16-CCITT over all bytes except this field
+};
+#pragma pack(pop)
+
+static_assert(sizeof(OrientationPacket) == 18 + 8 * IMU_COUNT, "OrientationPacket must be packed (34 bytes with two IMUs)");
+
+// ===================== Command Packet =====================
+// PKT_TYPE_CMD, host -> device, read by rxTask.
+enum CommandId : uint8_t {
+  CMD_SET_PROFILE = 1,       // arg = ProfileId
+  CMD_RECORD      = 2,       // arg = 1 start / 0 stop on-device recording (recorder.h)
+};
+
+#pragma pack(push, 1)
+struct CommandPacket {
+  uint16_t sync;             // 0xA55A
+  uint8_t  version;          // PKT_VER
+  uint8_t  type;             // PKT_TYPE_CMD
+  uint8_t  cmd;              // CommandId
+  uint8_t  arg;
+  uint16_t crc16;            // CRC16-CCITT over all bytes except this field
+};
+#pragma pack(pop)
+
+static_assert(sizeof(CommandPacket) == 8, "CommandPacket size must be 8 bytes");
+
+#endif // FRAME_PACKET_H
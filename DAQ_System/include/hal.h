@@ -0,0 +1,65 @@
+// hal.h
+// Thin hardware layer under the acquisition pipeline. Everything between the
+// samplers and the link that is plain computation (frame assembly and CRC:
+// pipeline.h, compression: frame_codec.h, flow control: flow_control.h) only
+// sees the hardware through these seams, so it also builds natively and can be
+// replayed and benchmarked off-target (DAQ_System/native/).
+//
+//   clock      halMicros / halCycles / halCpuMhz
+//   ADC source AdcSource: rows of one profile
+//   IMU source ImuSource: published IMU snapshots
+//   transport  Transport (transport.h)
+//
+// On the device the clock is Arduino/esp_cpu. The ADC and IMU sources there
+// are the sampler tasks themselves (adcTask with adc_dma.cpp or analogRead,
+// imuTask with bno055.cpp), since their pacing is interrupt and DMA driven;
+// the AdcSource / ImuSource classes are what the native harness plugs in
+// instead (synthetic or recorded streams).
+
+#ifndef HAL_H
+#define HAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "daq_config.h"
+#include "profiles.h"
+
+// ===================== Clock =====================
+#if defined(ARDUINO)
+#include <Arduino.h>
+#include <esp_cpu.h>
+
+inline uint32_t halMicros() { return (uint32_t)micros(); }
+inline uint32_t halCycles() { return (uint32_t)esp_cpu_get_cycle_count(); }
+inline uint32_t halCpuMhz() { return getCpuFrequencyMhz(); }
+#else
+// native/hal_native.cpp: steady_clock, one "cycle" per nanosecond.
+uint32_t halMicros();
+uint32_t halCycles();
+uint32_t halCpuMhz();
+#endif
+
+// ===================== Sources =====================
+class AdcSource {
+public:
+  virtual ~AdcSource() {}
+
+  // Start delivering rows of profile id, sample index from 0. Returns false if
+  // the source has nothing for that profile.
+  virtual bool begin(ProfileId id) = 0;
+  // Up to maxRows rows (idx, t_us, profile and the profile's channels filled).
+  // Returns fewer, or 0, at the end of a finite source.
+  virtual size_t read(AdcRow* rows, size_t maxRows) = 0;
+};
+
+class ImuSource {
+public:
+  virtual ~ImuSource() {}
+
+  // Latest snapshot and its publication count (SeqLock::read semantics: the
+  // count repeats while the values are unchanged).
+  virtual uint32_t read(ImuSnapshot& snap) = 0;
+};
+
+#endif // HAL_H
@@ -0,0 +1,76 @@
+// health.h
+// Task health: deadline misses, task watchdog, stack high-water marks.
+//
+// adcTask and imuTask are paced by sample clock alarms (sampling_timer.h),
+// and each wake-up must finish its work within one period of the alarm it
+// serves. A late finish, or a wake-up that found more than one alarm pending
+// (periods skipped), is a deadline miss. Its DeadlineMonitor counts and
+// timestamps it, and the row or IMU snapshot it produced carries a FrameFlag
+// into every frame built from it. The stats packet reports the counts, the
+// least free stack of each task, and the reset reason, so a burst of flagged
+// frames (device overload) can be told apart from frames the link lost.
+//
+// adcTask, imuTask and txTask are registered with the task watchdog and feed
+// it once per wake-up. A task stuck for HEALTH_WDT_TIMEOUT_MS reboots the
+// chip, and the next boot reports ESP_RST_TASK_WDT.
+//
+// DeadlineMonitor is portable: builds natively like pipeline.h.
+
+#ifndef HEALTH_H
+#define HEALTH_H
+
+#include <stdint.h>
+#include <atomic>
+
+#include "frame_packet.h"
+
+constexpr uint32_t HEALTH_WDT_TIMEOUT_MS = 3000; // > TX_IDLE_WAIT plus a stats write
+
+// One periodic task's deadline. Written by that task, read by txTask.
+class DeadlineMonitor {
+public:
+  // One wake-up: pending alarms served (> 1: periods were skipped), the time
+  // of the newest, and when its work finished. True if it missed its
+  // deadline; the miss is then counted.
+  bool check(uint32_t pending, uint32_t alarmUs, uint32_t doneUs, uint32_t periodUs) {
+    if (pending <= 1 && (int32_t)(doneUs - alarmUs) <= (int32_t)periodUs) return false;
+    miss(doneUs);
+    return true;
+  }
+
+  // Count a miss detected by other means (e.g. lost DMA results).
+  void miss(uint32_t nowUs) {
+    misses_.store(misses_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    lastMissUs_.store(nowUs ? nowUs : 1, std::memory_order_relaxed); // 0 means none
+  }
+
+  uint32_t misses() const { return misses_.load(std::memory_order_relaxed); }
+  uint32_t lastMissUs() const { return lastMissUs_.load(std::memory_order_relaxed); }
+
+private:
+  std::atomic<uint32_t> misses_{0};
+  std::atomic<uint32_t> lastMissUs_{0};
+};
+
+#if defined(ARDUINO)
+
+// setup(), before the tasks start: configure the task watchdog.
+void healthBegin();
+
+// First thing in each task: record its handle for healthStackFree() and, with
+// watchdog, subscribe it to the task watchdog.
+void healthWatch(StatsTaskId id, bool watchdog);
+
+// Watched tasks, once per wake-up.
+void healthFeed();
+
+// Least free stack of the task since it started, in bytes (STATS_STACK_UNKNOWN
+// if it never called healthWatch).
+uint16_t healthStackFree(StatsTaskId id);
+
+// esp_reset_reason() of this boot.
+uint8_t healthResetReason();
+
+#endif // ARDUINO
+
+#endif // HEALTH_H
@@ -0,0 +1,103 @@
+// imu_array.h
+// Compile-time IMU layout: where each of the IMU_COUNT BNO055s sits (I2C
+// controller, TCA9548A mux channel, address). imuTask and setup() walk
+// IMU_DEVICES; the snapshot and frame layouts follow from IMU_COUNT
+// (daq_config.h), so a different sensor count is a rebuild with
+// -DDAQ_IMU_COUNT=N and no code changes. DataLogger.IMU_COUNT must match.
+//
+// Default placement, by device index d (BNO055 address pin alternates):
+//   no mux        Wire: d = 0, 1 at 0x28/0x29; Wire1: d = 2, 3   (up to 4)
+//   DAQ_IMU_MUX   TCA9548A at IMU_MUX_ADDR on Wire, then Wire1: two IMUs per
+//                 mux channel, 16 per bus                        (up to 32)
+//   DAQ_IMU_PARALLEL  as above, but devices alternate between Wire (even d)
+//                 and Wire1 (odd d), and the two buses are read at the same
+//                 time, one task each (main.cpp, imuTask)
+// Edit IMU_DEVICES for another wiring; the checks below keep it consistent.
+// The frame formats set their own limit: a compressed EMG frame with every
+// IMU field must fit its one-byte len (frame_codec.h), i.e. IMU_COUNT <= 4.
+
+#ifndef IMU_ARRAY_H
+#define IMU_ARRAY_H
+
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+
+#include "daq_config.h"
+
+// 1 = BNO055s behind a TCA9548A I2C mux on each bus used.
+#ifndef DAQ_IMU_MUX
+#define DAQ_IMU_MUX 0
+#endif
+
+// 1 = spread the devices over both I2C controllers and read the buses in
+// parallel: a burst then costs the slower bus instead of the sum, and the two
+// limb segments are sampled within a few tens of us of each other.
+#ifndef DAQ_IMU_PARALLEL
+#define DAQ_IMU_PARALLEL 0
+#endif
+
+constexpr uint8_t BNO055_ADDR_A = 0x28;   // ADR pin low
+constexpr uint8_t BNO055_ADDR_B = 0x29;   // ADR pin high
+constexpr uint8_t IMU_MUX_ADDR  = 0x70;   // TCA9548A, A0..A2 low
+constexpr uint8_t IMU_MUX_CHANNELS = 8;
+constexpr uint8_t IMU_NO_MUX    = 0xFF;   // ImuDevice.mux: wired to the bus directly
+constexpr uint8_t IMU_MAX_BUSES = 2;      // ESP32 I2C controllers (Wire, Wire1)
+
+struct ImuDevice {
+  uint8_t bus;               // 0 = Wire, 1 = Wire1
+  uint8_t mux;               // TCA9548A channel, or IMU_NO_MUX
+  uint8_t addr;              // BNO055 7-bit address
+};
+
+constexpr size_t IMU_PER_BUS = DAQ_IMU_MUX ? 2 * IMU_MUX_CHANNELS : 2;
+
+constexpr ImuDevice imuDefaultDevice(size_t d) {
+  // bus, and the device's position n on it
+#if DAQ_IMU_PARALLEL
+  const size_t bus = d % IMU_MAX_BUSES, n = d / IMU_MAX_BUSES;
+#else
+  const size_t bus = d / IMU_PER_BUS, n = d % IMU_PER_BUS;
+#endif
+  const uint8_t addr = (n & 1) ? BNO055_ADDR_B : BNO055_ADDR_A;
+  return ImuDevice{(uint8_t)bus, DAQ_IMU_MUX ? (uint8_t)(n / 2) : IMU_NO_MUX, addr};
+}
+
+template <size_t... I>
+constexpr std::array<ImuDevice, sizeof...(I)> imuDefaultDevices(std::index_sequence<I...>) {
+  return {{imuDefaultDevice(I)...}};
+}
+
+constexpr std::array<ImuDevice, IMU_COUNT> IMU_DEVICES = imuDefaultDevices(std::make_index_sequence<IMU_COUNT>{});
+
+constexpr size_t imuBusCount() {
+  size_t n = 0;
+  for (const ImuDevice& d : IMU_DEVICES) {
+    if (d.bus + 1u > n) n = d.bus + 1u;
+  }
+  return n;
+}
+
+constexpr bool imuDevicesValid() {
+  for (size_t i = 0; i < IMU_COUNT; i++) {
+    const ImuDevice& a = IMU_DEVICES[i];
+    if (a.bus >= IMU_MAX_BUSES) return false;
+    if (a.addr != BNO055_ADDR_A && a.addr != BNO055_ADDR_B) return false;
+    if (DAQ_IMU_MUX ? a.mux >= IMU_MUX_CHANNELS : a.mux != IMU_NO_MUX) return false;
+    for (size_t j = 0; j < i; j++) {
+      const ImuDevice& b = IMU_DEVICES[j];
+      if (a.bus == b.bus && a.mux == b.mux && a.addr == b.addr) return false;
+    }
+  }
+  return true;
+}
+
+constexpr size_t IMU_BUSES = imuBusCount();
+
+static_assert(imuDevicesValid(), "IMU_DEVICES: bus, mux channel or address out of range, or two devices collide");
+#if DAQ_IMU_PARALLEL
+static_assert(IMU_BUSES == IMU_MAX_BUSES, "DAQ_IMU_PARALLEL needs devices on both buses");
+#endif
+
+#endif // IMU_ARRAY_H
@@ -0,0 +1,37 @@
+// imu_scale.h
+// Compile-time integer unit conversion from sensor LSBs to wire units.
+// Each conversion is a constexpr ratio Num/Den applied to the raw register
+// value with round-half-away-from-zero (same as lroundf) and int16 saturation
+// instead of wrap-around.
+
+#ifndef IMU_SCALE_H
+#define IMU_SCALE_H
+
+#include <stdint.h>
+#include "daq_config.h"
+
+template <int32_t Num, int32_t Den>
+struct ScaleRatio {
+  static_assert(Den > 0, "ScaleRatio denominator must be positive");
+  // int16 raw x Num must fit int32 without overflow
+  static_assert(Num > -65536 && Num < 65536, "ScaleRatio numerator too large");
+
+  static constexpr sample_t apply(int16_t raw) {
+    const int32_t p = (int32_t)raw * Num;
+    const int32_t q = (p >= 0 ? p + Den / 2 : p - Den / 2) / Den;
+    return q > INT16_MAX ? INT16_MAX : (q < INT16_MIN ? INT16_MIN : (sample_t)q);
+  }
+};
+
+// BNO055 (default UNIT_SEL) -> x100 wire units
+using Bno055AccScale = ScaleRatio<1, 1>;   // 1 m/s^2 = 100 LSB -> m/s^2 x100
+using Bno055MagScale = ScaleRatio<25, 4>;  // 1 uT = 16 LSB     -> uT x100
+// 1 dps = 16 LSB -> rad/s x100 = raw * 100*pi/(180*16), in Q16
+using Bno055GyrScale = ScaleRatio<(int32_t)(100.0 * 3.14159265358979323846 / (180.0 * 16.0) * 65536.0 + 0.5), 65536>;
+
+static_assert(Bno055AccScale::apply(-981) == -981, "acc scale");
+static_assert(Bno055MagScale::apply(16) == 100 && Bno055MagScale::apply(-2) == -13, "mag scale");
+static_assert(Bno055MagScale::apply(INT16_MAX) == INT16_MAX, "mag scale must saturate");
+static_assert(Bno055GyrScale::apply(32000) == 3491 && Bno055GyrScale::apply(-16) == -2, "gyro scale");
+
+#endif // IMU_SCALE_H
@@ -0,0 +1,97 @@
+// orientation.h
+// Optional orientation output stage. The BNO055s already run their on-chip
+// NDOF fusion (the Adafruit begin() default), so instead of a second filter on
+// core 0, imuTask reads each device's fused quaternion in the same I2C burst as
+// the raw data (bno055ReadAmgQuat) and sends one PKT_TYPE_ORIENTATION packet
+// per IMU sample: both quaternions plus the joint angle between the two
+// segments. A controller can then use orientation without fusing the raw
+// stream itself. Frames and their raw IMU block are unchanged.
+//
+// Portable: builds natively like pipeline.h.
+
+#ifndef ORIENTATION_H
+#define ORIENTATION_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "crc16.h"
+#include "daq_config.h"
+#include "frame_packet.h"
+
+// 1 = imuTask reads the fused quaternions and txTask sends orientation packets.
+#ifndef DAQ_ORIENTATION
+#define DAQ_ORIENTATION 0
+#endif
+
+// Axis (0 = x, 1 = y, 2 = z) of both sensors that is mounted along the joint's
+// rotation axis; the joint angle is the rotation of IMU 1 relative to IMU 0
+// about it (e.g. thigh and shank IMU -> knee flexion).
+constexpr uint8_t  JOINT_AXIS = 0;
+constexpr size_t   ORIENT_RING_LEN = 8;    // imuTask -> txTask, 80ms at IMU_HZ
+constexpr size_t   ORIENT_BURST = 4;       // orientation packets per transport write
+
+#if DAQ_ORIENTATION
+static_assert(IMU_COUNT >= 2, "the joint angle needs two IMUs");
+static_assert(IMU_COUNT <= 8, "OrientationPacket.valid has one bit per IMU");
+#endif
+static_assert(JOINT_AXIS < 3, "JOINT_AXIS is x, y or z");
+
+struct Quat {
+  float w, x, y, z;
+};
+
+// BNO055 units (ORIENT_QUAT_ONE = 1.0) -> Quat. False for the all-zero output
+// the sensor gives before its fusion has started.
+inline bool quatFromBno055(const int16_t q[4], Quat& out) {
+  constexpr float s = 1.0f / ORIENT_QUAT_ONE;
+  out = Quat{q[0] * s, q[1] * s, q[2] * s, q[3] * s};
+  return out.w * out.w + out.x * out.x + out.y * out.y + out.z * out.z > 0.5f;
+}
+
+// conj(a) * b: rotation b expressed in the frame of a.
+inline Quat quatRelative(const Quat& a, const Quat& b) {
+  return Quat{
+    a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z,
+    a.w * b.x - a.x * b.w - a.y * b.z + a.z * b.y,
+    a.w * b.y + a.x * b.z - a.y * b.w - a.z * b.x,
+    a.w * b.z - a.x * b.y + a.y * b.x - a.z * b.w,
+  };
+}
+
+// Swing-twist: angle of the twist of q about axis, in (-180, 180] degrees x 100.
+inline int16_t quatTwistCdeg(const Quat& q, uint8_t axis) {
+  const float v = axis == 0 ? q.x : (axis == 1 ? q.y : q.z);
+  // q and -q are the same rotation; w >= 0 keeps the angle in (-pi, pi]
+  const float a = q.w < 0 ? 2.0f * atan2f(-v, -q.w) : 2.0f * atan2f(v, q.w);
+  return (int16_t)lrintf(a * (18000.0f / (float)M_PI));
+}
+
+// Build one orientation packet from the latest quaternion of each device;
+// fresh has bit d set for devices whose quaternion this burst read. A device
+// whose fusion has not started is left out of valid, and the joint angle is
+// ORIENT_JOINT_INVALID unless both are valid.
+inline void orientationPacketFill(OrientationPacket& o, uint16_t seq, uint16_t imuSeq, uint32_t tUs,
+                                  const int16_t quat[IMU_COUNT][4], uint8_t fresh) {
+  o.sync = SYNC_WORD;
+  o.version = PKT_VER;
+  o.type = PKT_TYPE_ORIENTATION;
+  o.orient_seq = seq;
+  o.imu_seq = imuSeq;
+  o.t_us = tUs;
+
+  Quat q[IMU_COUNT];
+  uint8_t valid = 0;
+  for (size_t d = 0; d < IMU_COUNT; d++) {
+    memcpy(o.quat[d], quat[d], sizeof(o.quat[d]));
+    if ((fresh & (1u << d)) && quatFromBno055(quat[d], q[d])) valid |= 1u << d;
+  }
+  o.valid = valid;
+  o.joint_cdeg = (valid & 3u) == 3u ? quatTwistCdeg(quatRelative(q[0], q[1]), JOINT_AXIS)
+                                    : ORIENT_JOINT_INVALID;
+  o.crc16 = crc16_ccitt((const uint8_t*)&o, sizeof(OrientationPacket) - sizeof(o.crc16));
+}
+
+#endif // ORIENTATION_H
@@ -0,0 +1,43 @@
+// packet_pool.h
+// Fixed-size packet pool with free-list recycling.
+// The producer fills a slot in place and queues only its pointer; the consumer
+// returns the slot once written out. The free list is an SpscRing, so exactly one
+// task may acquire() and exactly one (other) task may release().
+
+#ifndef PACKET_POOL_H
+#define PACKET_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "spsc_ring.h"
+
+template <typename T, size_t N>
+class PacketPool {
+public:
+  PacketPool() {
+    for (size_t i = 0; i < N; i++) free_.push((uint16_t)i);
+  }
+
+  // Producer side: next free slot, or nullptr when every slot is in flight.
+  T* acquire() {
+    uint16_t i;
+    return free_.pop(i) ? &slots_[i] : nullptr;
+  }
+
+  // Consumer side: hand a slot obtained from acquire() back to the pool.
+  void release(T* p) {
+    free_.push((uint16_t)(p - slots_));
+  }
+
+  size_t available() const { return free_.size(); }
+  static constexpr size_t capacity() { return N; }
+
+private:
+  static_assert(N <= 65536, "PacketPool index must fit in uint16_t");
+
+  T slots_[N];
+  SpscRing<uint16_t, N> free_;
+};
+
+#endif // PACKET_POOL_H
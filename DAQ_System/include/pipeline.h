@@ -0,0 +1,145 @@
+// pipeline.h
+// Portable frame assembly, shared by packerTask and the native harness:
+// ADC rows of one profile -> FramePacketT blocks -> sealed frame (header,
+// IMU snapshot, imu_dt, CRC). No RTOS or hardware access (hal.h).
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "crc16.h"
+#include "daq_config.h"
+#include "frame_packet.h"
+#include "profiles.h"
+
+// Capture time relative to the frame's t_us, in IMU_DT_UNIT_US steps (rounded,
+// saturating to IMU_DT_INVALID when too old). A capture time of 0 means never
+// captured and is IMU_DT_INVALID, whatever frameUs is.
+inline int16_t imuTimeOffset(uint32_t captureUs, uint32_t frameUs) {
+  if (captureUs == 0) return IMU_DT_INVALID;
+  const int32_t d = (int32_t)(captureUs - frameUs);
+  const int32_t unit = (int32_t)IMU_DT_UNIT_US; // signed: d may be negative
+  const int32_t q = (d >= 0 ? d + unit / 2 : d - unit / 2) / unit;
+  return q > INT16_MAX ? INT16_MAX : (q <= IMU_DT_INVALID ? IMU_DT_INVALID : (int16_t)q);
+}
+
+// Extends 32-bit micros() readings (AdcRow.t_us) to the 64-bit frame t_us.
+// Holds while successive readings are less than ~35 min apart; a reading
+// slightly older than the previous one steps back instead of wrapping.
+class WideMicros {
+public:
+  uint64_t extend(uint32_t us) {
+    if (!started_) {
+      now_ = us;
+      started_ = true;
+    } else {
+      now_ += (int64_t)(int32_t)(us - (uint32_t)now_);
+    }
+    return now_;
+  }
+
+private:
+  uint64_t now_ = 0;
+  bool     started_ = false;
+};
+
+// Frame boundaries of a row stream from the sample indices alone. A row that
+// does not follow the previous one (a skipped index or a dropped row) restarts
+// the block at that row, so blocks need not start at a multiple of
+// P::ADC_BLOCK. FrameAssembler is built on it; the sampler runs one over the
+// rows it hands to the packer, to wake it exactly when a frame completes.
+template <class P>
+class BlockTracker {
+public:
+  // True if the row with index idx will be the first of a block.
+  bool starts(uint32_t idx) {
+    if (pos_ != 0 && idx != expectIdx_) pos_ = 0;
+    return pos_ == 0;
+  }
+
+  // Count the row; true once it completes a block.
+  bool add(uint32_t idx) {
+    starts(idx);
+    expectIdx_ = idx + 1;
+    if (++pos_ < P::ADC_BLOCK) return false;
+    pos_ = 0;
+    return true;
+  }
+
+  // Rows of the current block so far (after starts()).
+  uint8_t pos() const { return pos_; }
+
+private:
+  uint8_t  pos_ = 0;
+  uint32_t expectIdx_ = 0;
+};
+
+// Collects P::ADC_BLOCK consecutive rows into a frame's adc[] block.
+template <class P>
+class FrameAssembler {
+public:
+  using Packet = ProfilePacket<P>;
+
+  // True if row will be the first of a frame: the caller picks the buffer
+  // before add(). A dropped row breaks the block, so the frame restarts at the
+  // row and adc_base_idx + i always names the real sample.
+  bool starts(const AdcRow& row) { return block_.starts(row.idx); }
+
+  // Copy row into p; true once p holds a complete block.
+  bool add(const AdcRow& row, Packet& p) {
+    if (block_.starts(row.idx)) {
+      startUs_ = row.t_us;
+      flags_ = 0;
+      p.adc_base_idx = row.idx; // index of the first sample in this frame
+    }
+    flags_ |= row.flags;
+    memcpy(p.adc[block_.pos()], row.adc, sizeof(p.adc[0]));
+    return block_.add(row.idx);
+  }
+
+  // t_us of the first row of the frame being assembled.
+  uint32_t startUs() const { return startUs_; }
+
+  // FrameFlag bits of its rows so far.
+  uint8_t flags() const { return flags_; }
+
+private:
+  BlockTracker<P> block_;
+  uint8_t  flags_ = 0;
+  uint32_t startUs_ = 0;
+};
+
+// Fill in the header and IMU block of an assembled frame and its CRC; tUs is
+// the assembler's startUs() widened by the caller's WideMicros, flags its
+// flags(). The snapshot's flags are added.
+template <class P>
+inline void frameSeal(ProfilePacket<P>& p, uint32_t seq, uint64_t tUs, uint8_t flags, uint16_t imuSeq,
+                      const ImuSnapshot& snap) {
+  using Packet = ProfilePacket<P>;
+  p.sync = SYNC_WORD;
+  p.version = PKT_VER;
+  p.type = PKT_TYPE_FRAME;
+  p.frame_seq = seq;
+  p.t_us = tUs;
+  p.profile = P::ID;
+  p.flags = flags | snap.flags;
+
+  // CRC is built up as each section is filled (covers everything except crc16)
+  Crc16 crc;
+  crc.update(&p, offsetof(Packet, imu));
+
+  p.imu_seq = imuSeq;
+  memcpy(p.imu, snap.v, sizeof(p.imu));
+  for (size_t d = 0; d < IMU_COUNT; d++) {
+    p.imu_dt[d][0] = imuTimeOffset(snap.t_us[d], (uint32_t)tUs);
+    p.imu_dt[d][1] = imuTimeOffset(snap.t_mag_us[d], (uint32_t)tUs);
+  }
+  crc.update(p.imu, sizeof(p.imu) + sizeof(p.imu_seq) + sizeof(p.imu_dt));
+
+  p.crc16 = crc.value();
+}
+
+#endif // PIPELINE_H
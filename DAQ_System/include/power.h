@@ -0,0 +1,69 @@
+// power.h
+// Optional power-aware acquisition (DAQ_POWER). powerBegin() enables dynamic
+// frequency scaling and automatic light sleep (esp_pm; the sdkconfig needs
+// CONFIG_PM_ENABLE, and CONFIG_FREERTOS_USE_TICKLESS_IDLE for the sleep), so
+// the chip sleeps whenever every task is blocked. Two PM locks keep the normal
+// behaviour in profiles that stream at full rate:
+//   CPU_FREQ_MAX    CPU at POWER_MAX_CPU_MHZ
+//   NO_LIGHT_SLEEP  no sleep between samples
+// powerSaving() profiles release both. In them adcTask runs its sample clocks
+// from esp_timer: esp_timer keeps time through light sleep and wakes the chip
+// for its alarms, while the hw_timer clocks hold an APB lock as long as they
+// exist. txTask also lingers POWER_TX_LINGER_US per burst. The chip then wakes
+// for one ADC read per sample, one I2C burst per IMU tick and one link write
+// per batch, and the sample stream is unchanged.
+//
+// The cost is wake latency: STAGE_ADC_WAKE in the stats packet is the time from
+// a sample clock alarm to adcTask running, light-sleep exit included.
+//
+// Limits:
+//   DMA ADC   adc_continuous holds its own PM lock while it converts, so
+//             with DAQ_ADC_DMA a saving profile gets DFS but no light sleep.
+//   BNO055    no FIFO, and its INT pin only signals motion events, not data
+//             ready, so imuTask still polls it once per IMU tick.
+//   link      only the UART link sleeps. The chip wakes on RX edges and the
+//             bytes that wake it are lost, so the host repeats a command that
+//             gets no answer. With other links esp_pm runs DFS only.
+//   DFS       stage times in cycles are converted at the current CPU clock,
+//             which stays at POWER_MIN_CPU_MHZ while a saving profile runs.
+
+#ifndef POWER_H
+#define POWER_H
+
+#include <stdint.h>
+
+#include "daq_config.h"
+#include "profiles.h"
+
+// 1 = DFS, automatic light sleep and the low-power sample clocks above.
+#ifndef DAQ_POWER
+#define DAQ_POWER 0
+#endif
+
+constexpr uint32_t POWER_MAX_CPU_MHZ    = 240;
+constexpr uint32_t POWER_MIN_CPU_MHZ    = 80;      // APB stays at 80MHz: UART baud and I2C timing hold
+constexpr uint32_t POWER_TX_LINGER_US   = 200000;  // 4 frames of low_power per link write
+constexpr int      POWER_UART_WAKE_EDGES = 3;      // RX edges that wake the chip from light sleep
+
+// Profiles that let the chip slow down and sleep between samples.
+constexpr bool powerSaving(uint8_t id) {
+  return DAQ_POWER && id == PROFILE_LOW_POWER;
+}
+
+#if DAQ_POWER
+
+// setup(), before the tasks start: configure esp_pm and take both locks.
+void powerBegin();
+
+// adcTask, when a profile starts: release the locks for a powerSaving()
+// profile, take them back for any other.
+void powerProfile(ProfileId id);
+
+#else
+
+inline void powerBegin() {}
+inline void powerProfile(ProfileId) {}
+
+#endif // DAQ_POWER
+
+#endif // POWER_H
@@ -0,0 +1,95 @@
+// profiler.h
+// Low-overhead latency histograms for the acquisition pipeline.
+// Each ProfHistogram has one writer (the task it measures) and one reader (the
+// stats builder in txTask). Records go to the active bank; collect() reads the
+// bank retired at the previous call and then swaps, so the reader never touches
+// a bank that is being written and no lock is needed.
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+
+// Log-linear buckets: exact below 16, then 4 sub-buckets per power of two
+// (<= 25% bucket width), covering the full uint32_t range.
+constexpr size_t PROF_BUCKETS = 16 + 28 * 4;
+
+struct ProfSummary {
+  uint32_t count;
+  uint32_t min;
+  uint32_t mean;
+  uint32_t p99;              // upper bound of the bucket holding the 99th percentile
+  uint32_t max;
+};
+
+class ProfHistogram {
+public:
+  void record(uint32_t v) {
+    Bank& b = banks_[active_.load(std::memory_order_acquire)];
+    if (b.count == 0 || v < b.min) b.min = v;
+    if (v > b.max) b.max = v;
+    b.sum += v;
+    b.buckets[bucketOf(v)]++;
+    b.count++;
+  }
+
+  // Summarise the window that ended at the previous collect() and start a new one.
+  ProfSummary collect() {
+    const uint8_t cur = active_.load(std::memory_order_relaxed);
+    Bank& b = banks_[cur ^ 1];
+
+    ProfSummary s{};
+    s.count = b.count;
+    if (b.count) {
+      s.min = b.min;
+      s.max = b.max;
+      s.mean = (uint32_t)(b.sum / b.count);
+
+      const uint32_t rank = b.count - b.count / 100; // 99th percentile rank
+      uint32_t seen = 0;
+      for (size_t i = 0; i < PROF_BUCKETS; i++) {
+        seen += b.buckets[i];
+        if (seen >= rank) {
+          s.p99 = bucketUpper((uint8_t)i);
+          if (s.p99 > s.max) s.p99 = s.max;
+          break;
+        }
+      }
+    }
+
+    memset(&b, 0, sizeof(b));
+    active_.store(cur ^ 1, std::memory_order_release);
+    return s;
+  }
+
+private:
+  struct Bank {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t buckets[PROF_BUCKETS];
+  };
+
+  static inline uint8_t bucketOf(uint32_t v) {
+    if (v < 16) return (uint8_t)v;
+    const uint32_t e = 31 - (uint32_t)__builtin_clz(v); // 4..31
+    return (uint8_t)(16 + (e - 4) * 4 + ((v >> (e - 2)) & 3));
+  }
+
+  static inline uint32_t bucketUpper(uint8_t b) {
+    if (b < 16) return b;
+    const uint32_t e = 4 + (b - 16) / 4;
+    const uint32_t sub = (b - 16) % 4;
+    const uint64_t upper = ((uint64_t)(4 + sub + 1) << (e - 2)) - 1;
+    return upper > 0xFFFFFFFFu ? 0xFFFFFFFFu : (uint32_t)upper;
+  }
+
+  Bank banks_[2] = {};
+  std::atomic<uint8_t> active_{0};
+};
+
+#endif // PROFILER_H
@@ -0,0 +1,108 @@
+// profiles.h
+// Acquisition profiles, selectable at runtime with CMD_SET_PROFILE.
+// Each profile is a compile-time trait set: the sampler and packer loops are
+// instantiated once per profile, so channel count and block size stay
+// constants in the hot path. PROFILES[] mirrors the traits for code that only
+// needs them at runtime. Every frame carries its profile id (FramePacketT).
+
+#ifndef PROFILES_H
+#define PROFILES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "daq_config.h"
+#include "frame_packet.h"
+
+enum ProfileId : uint8_t {
+  PROFILE_BALANCED = 0,      // all channels @ ADC_HZ, IMUs @ IMU_HZ (boot default)
+  PROFILE_EMG,               // first 2 channels @ 4kHz
+  PROFILE_LOW_POWER,         // all channels @ 100Hz, IMUs @ 20Hz
+  PROFILE_COUNT
+};
+
+template <ProfileId Id> struct Profile;
+
+template <> struct Profile<PROFILE_BALANCED> {
+  static constexpr ProfileId ID        = PROFILE_BALANCED;
+  static constexpr uint32_t  ADC_HZ    = ::ADC_HZ;
+  static constexpr uint8_t   ADC_CH    = (uint8_t)::ADC_CH;
+  static constexpr uint8_t   ADC_BLOCK = ::ADC_BLOCK;  // 100 frames/s
+  static constexpr uint32_t  IMU_HZ    = ::IMU_HZ;
+};
+
+template <> struct Profile<PROFILE_EMG> {
+  static constexpr ProfileId ID        = PROFILE_EMG;
+  static constexpr uint32_t  ADC_HZ    = 4000;
+  static constexpr uint8_t   ADC_CH    = 2;            // first two ADC inputs
+  static constexpr uint8_t   ADC_BLOCK = 40;           // 100 frames/s
+  static constexpr uint32_t  IMU_HZ    = ::IMU_HZ;
+};
+
+template <> struct Profile<PROFILE_LOW_POWER> {
+  static constexpr ProfileId ID        = PROFILE_LOW_POWER;
+  static constexpr uint32_t  ADC_HZ    = 100;
+  static constexpr uint8_t   ADC_CH    = (uint8_t)::ADC_CH;
+  static constexpr uint8_t   ADC_BLOCK = 5;            // 20 frames/s
+  static constexpr uint32_t  IMU_HZ    = 20;
+};
+
+// Frame layout of a profile.
+template <class P>
+using ProfilePacket = FramePacketT<P::ADC_CH, P::ADC_BLOCK>;
+
+// ===================== Runtime view =====================
+struct ProfileInfo {
+  uint32_t adcHz;
+  uint8_t  adcCh;
+  uint8_t  adcBlock;
+  uint32_t imuHz;
+  uint16_t frameBytes;       // sizeof(ProfilePacket<P>)
+};
+
+template <class P>
+constexpr ProfileInfo profileInfo() {
+  static_assert(P::ADC_CH >= 1 && P::ADC_CH <= ADC_CH, "profile uses more channels than ADC_CH");
+  static_assert(P::ADC_BLOCK >= 2, "profile block must hold at least 2 samples");
+  static_assert(P::ADC_HZ % P::ADC_BLOCK == 0, "profile frame rate must be a whole number");
+  return ProfileInfo{P::ADC_HZ, P::ADC_CH, P::ADC_BLOCK, P::IMU_HZ,
+                     (uint16_t)sizeof(ProfilePacket<P>)};
+}
+
+constexpr ProfileInfo PROFILES[PROFILE_COUNT] = {
+  profileInfo<Profile<PROFILE_BALANCED>>(),
+  profileInfo<Profile<PROFILE_EMG>>(),
+  profileInfo<Profile<PROFILE_LOW_POWER>>(),
+};
+
+constexpr size_t profileMaxFrameBytes() {
+  size_t m = 0;
+  for (size_t i = 0; i < PROFILE_COUNT; i++) {
+    if (PROFILES[i].frameBytes > m) m = PROFILES[i].frameBytes;
+  }
+  return m;
+}
+
+constexpr size_t profileMaxBlock() {
+  size_t m = 0;
+  for (size_t i = 0; i < PROFILE_COUNT; i++) {
+    if (PROFILES[i].adcBlock > m) m = PROFILES[i].adcBlock;
+  }
+  return m;
+}
+
+constexpr size_t FRAME_MAX_BYTES  = profileMaxFrameBytes();
+constexpr size_t PROFILE_MAX_BLOCK = profileMaxBlock();
+
+// Call f(Profile<id>{}) for a runtime id; f is typically a generic lambda, so
+// its body is instantiated once per profile. Unknown ids fall back to BALANCED.
+template <class F>
+inline void withProfile(uint8_t id, F&& f) {
+  switch (id) {
+    case PROFILE_EMG:       f(Profile<PROFILE_EMG>{}); break;
+    case PROFILE_LOW_POWER: f(Profile<PROFILE_LOW_POWER>{}); break;
+    default:                f(Profile<PROFILE_BALANCED>{}); break;
+  }
+}
+
+#endif // PROFILES_H
@@ -0,0 +1,80 @@
+// recorder.h
+// On-device recording of the raw frame stream for untethered sessions.
+// packerTask appends every frame to a RECORD_BLOCK_BYTES buffer; full buffers
+// go to a low-priority writer task that stores them, whole and sector aligned,
+// on an SD card or a flash data partition while the packer fills the next one.
+// While recording, the link only carries 1 in RECORD_PREVIEW_DIV frames.
+//
+// The recording is the same byte stream the link carries (FramePackets back
+// to back), so DataLogger.read_recording() parses it with the normal
+// sync/CRC scan. Frames may span blocks.
+
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "daq_config.h"
+
+#define DAQ_RECORD_NONE   0
+#define DAQ_RECORD_SD     1   // SD_MMC (4-bit SDMMC slot), one /daq_NNNN.bin per session
+#define DAQ_RECORD_FLASH  2   // data partition RECORD_PARTITION, used as a ring
+
+#ifndef DAQ_RECORD
+#define DAQ_RECORD DAQ_RECORD_NONE
+#endif
+
+// 1 = start recording at boot (no host needed); otherwise wait for CMD_RECORD.
+#ifndef DAQ_RECORD_AUTOSTART
+#define DAQ_RECORD_AUTOSTART 1
+#endif
+
+constexpr size_t   RECORD_BLOCK_BYTES = 16384;  // 4 flash sectors / 32 SD sectors
+constexpr size_t   RECORD_BLOCKS      = 2;      // double buffered: ~0.7s of EMG frames each
+constexpr uint32_t RECORD_PREVIEW_DIV = 10;     // live preview rate while recording
+constexpr uint32_t RECORD_SD_FLUSH_BLOCKS = 16; // SD: update the FAT every ~10-20s
+constexpr const char* RECORD_PARTITION = "daqrec";
+
+static_assert(RECORD_BLOCK_BYTES % 4096 == 0, "record blocks must be whole flash sectors");
+static_assert(RECORD_BLOCKS >= 2, "the packer needs a block to fill while one is written");
+
+// Writer-side counters (writer task), plus frames the packer could not fit.
+struct RecorderStats {
+  uint32_t blocksWritten;
+  uint32_t writeErrors;
+  uint32_t maxWriteUs;       // longest single block write (erase included)
+  uint32_t droppedFrames;    // no free block: the writer fell behind (the frame goes to the link)
+};
+
+#if DAQ_RECORD
+
+// Mount the medium and start the writer task. Returns false (and records
+// nothing) if the card or partition is missing.
+bool recorderBegin();
+
+// Request start / stop (any task). The packer picks the request up at its next
+// frame; a stop flushes the partial block and closes the session.
+void recorderRequest(bool on);
+
+// packerTask only: append one frame if a session is active. Returns true if
+// the frame was recorded (the caller may then thin the live link); a frame
+// that did not fit is counted in droppedFrames and must still be sent.
+bool recorderAppend(const uint8_t* frame, size_t len);
+
+// Read by txTask for the stats packet.
+const RecorderStats& recorderStats();
+
+#else
+
+inline bool recorderBegin() { return false; }
+inline void recorderRequest(bool) {}
+inline bool recorderAppend(const uint8_t*, size_t) { return false; }
+inline const RecorderStats& recorderStats() {
+  static const RecorderStats none{};
+  return none;
+}
+
+#endif // DAQ_RECORD
+
+#endif // RECORDER_H
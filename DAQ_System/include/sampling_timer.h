@@ -0,0 +1,35 @@
+// sampling_timer.h
+// Sample scheduler: T1 fires at the ADC rate, T2 at the IMU rate, from
+// hw_timer_t alarms, or from esp_timer ones in a power-saving profile (power.h).
+// Both timers start from the same instant, so sample times are derived from
+// the tick number instead of the FreeRTOS tick or the task wake-up time.
+
+#ifndef SAMPLING_TIMER_H
+#define SAMPLING_TIMER_H
+
+#include "daq_config.h"
+
+// 10MHz timer clock: 0.1us alarm resolution, so rates need not divide 1ms.
+constexpr uint32_t SAMPLING_TIMER_HZ = 10000000;
+
+constexpr uint64_t samplingTimerTicks(uint32_t hz) {
+  return (SAMPLING_TIMER_HZ + hz / 2) / hz;
+}
+
+// (Re)start both timers at the given rates from a new common epoch and attach
+// T1_callback / T2_callback. Ticks passed to *TickTimeUs() count from this epoch.
+// startAdc=false leaves T1 off (the DMA backend has its own sample clock).
+// sleepable=true runs both clocks from esp_timer instead, which counts through
+// light sleep and wakes the chip for each alarm. Its periods are whole
+// microseconds, and the hw timers are deleted so their PM lock is released.
+// Called from adcTask only (boot and every profile switch).
+void samplingTimersStart(uint32_t adcHz, uint32_t imuHz, bool startAdc, bool sleepable = false);
+
+// micros()-based time of the given tick (tick 1 is the first alarm).
+uint32_t adcTickTimeUs(uint32_t tick);
+uint32_t imuTickTimeUs(uint32_t tick);
+
+// T1 alarms since samplingTimersStart(): the newest ADC tick number.
+uint32_t adcTickCount();
+
+#endif // SAMPLING_TIMER_H
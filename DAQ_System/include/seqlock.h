@@ -0,0 +1,46 @@
+// seqlock.h
+// Single-writer sequence lock for publishing a small POD snapshot across cores.
+// The writer never waits and never disables interrupts; a reader that overlaps
+// a write simply copies again. seq is even when stable, odd while writing, so
+// seq/2 counts publications and tells a fresh snapshot from a repeated one.
+
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+template <typename T>
+class SeqLock {
+  static_assert(std::is_trivially_copyable<T>::value, "SeqLock needs a trivially copyable T");
+
+public:
+  // Writer side (one task only). Wait-free.
+  void write(const T& v) {
+    const uint32_t s = seq_.load(std::memory_order_relaxed);
+    seq_.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&data_, &v, sizeof(T));
+    seq_.store(s + 2, std::memory_order_release);
+  }
+
+  // Reader side (any task). Returns the publication count of the copy.
+  uint32_t read(T& out) const {
+    uint32_t s0, s1;
+    do {
+      s0 = seq_.load(std::memory_order_acquire);
+      memcpy(&out, &data_, sizeof(T));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      s1 = seq_.load(std::memory_order_relaxed);
+    } while ((s0 & 1) || s0 != s1);
+    return s0 >> 1;
+  }
+
+private:
+  std::atomic<uint32_t> seq_{0};
+  T data_{};
+};
+
+#endif // SEQLOCK_H
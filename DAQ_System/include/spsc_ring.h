@@ -0,0 +1,52 @@
+// spsc_ring.h
+// Lock-free single-producer / single-consumer ring buffer.
+// One task (or ISR) pushes, one other task pops; no critical sections needed,
+// so the producer side never disables interrupts or spins on the other core.
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+template <typename T, size_t N>
+class SpscRing {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+  // Producer side. Returns false (and leaves the ring untouched) when full.
+  bool push(const T& item) {
+    const uint32_t head = head_.load(std::memory_order_relaxed);
+    const uint32_t tail = tail_.load(std::memory_order_acquire);
+    if ((uint32_t)(head - tail) >= N) return false;
+    buf_[head & (N - 1)] = item;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side. Returns false when empty.
+  bool pop(T& out) {
+    const uint32_t tail = tail_.load(std::memory_order_relaxed);
+    const uint32_t head = head_.load(std::memory_order_acquire);
+    if (head == tail) return false;
+    out = buf_[tail & (N - 1)];
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Approximate fill level; exact when called from either owner side.
+  size_t size() const {
+    return (size_t)(head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire));
+  }
+
+  bool empty() const { return size() == 0; }
+  static constexpr size_t capacity() { return N; }
+
+private:
+  T buf_[N];
+  std::atomic<uint32_t> head_{0}; // written by producer only
+  std::atomic<uint32_t> tail_{0}; // written by consumer only
+};
+
+#endif // SPSC_RING_H
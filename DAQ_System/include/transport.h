@@ -0,0 +1,68 @@
+// transport.h
+// Byte-stream transports underneath txTask. txTask hands each coalesced burst
+// to transport().write(); which link carries it is a compile-time choice.
+// rxTask reads host commands from the same link with transport().read().
+
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "daq_config.h"
+#include "frame_packet.h"
+#include "profiles.h"
+
+// Largest UDP payload that fits one 1500-byte MTU without IP fragmentation.
+constexpr size_t UDP_MAX_PAYLOAD = 1472;
+
+// TX batching: one transport write per burst of queued frames, up to
+// TX_BATCH_MAX_FRAMES frames or TX_BATCH_MAX_BYTES bytes (frame size depends on
+// the profile). With TX_BATCH_MAX_US = 0 only frames already queued are
+// coalesced (no added latency). Over UDP the task lingers so each burst fills
+// one datagram.
+#if DAQ_TRANSPORT == DAQ_TRANSPORT_UDP
+constexpr size_t   TX_BATCH_MAX_FRAMES = 16;
+constexpr size_t   TX_BATCH_MAX_BYTES  = UDP_MAX_PAYLOAD; // 11 balanced / 6 EMG frames
+constexpr uint32_t TX_BATCH_MAX_US     = 20000;
+#else
+constexpr size_t   TX_BATCH_MAX_FRAMES = 16;
+constexpr size_t   TX_BATCH_MAX_BYTES  = TX_BATCH_MAX_FRAMES * FRAME_MAX_BYTES;
+constexpr uint32_t TX_BATCH_MAX_US     = 0;
+#endif
+
+static_assert(TX_BATCH_MAX_BYTES >= FRAME_MAX_BYTES, "a TX burst must hold at least one frame");
+
+// Per-link counters, updated only from txTask.
+struct TransportStats {
+  uint32_t bytes;          // payload bytes accepted by the driver
+  uint32_t writes;         // write() calls (one per burst)
+  uint32_t shortWrites;    // bursts the driver did not fully accept
+  uint32_t maxWriteUs;     // longest time a write() blocked
+  uint32_t txHighWater;    // peak bytes pending in the driver TX buffer
+};
+
+class Transport {
+public:
+  virtual ~Transport() {}
+
+  virtual bool begin() = 0;
+  virtual size_t write(const uint8_t* data, size_t len) = 0;
+  // Wait up to timeoutMs for input, then return whatever is buffered (<= maxLen).
+  virtual size_t read(uint8_t* buf, size_t maxLen, uint32_t timeoutMs) = 0;
+  virtual const char* name() const = 0;
+
+  const TransportStats& stats() const { return stats_; }
+
+protected:
+  TransportStats stats_{};
+};
+
+// The transport selected by DAQ_TRANSPORT.
+Transport& transport();
+
+#if DAQ_TRANSPORT == DAQ_TRANSPORT_UDP
+Transport& udpTransport(); // transport_udp.cpp
+#endif
+
+#endif // TRANSPORT_H
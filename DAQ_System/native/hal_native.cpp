@@ -0,0 +1,14 @@
+#include <chrono>
+#include "hal.h"
+
+// Native clock: steady_clock since the first call. halCycles() counts
+// nanoseconds, so cycles * 1000 / halCpuMhz() is ns here as on the device.
+static uint64_t nowNs() {
+  using namespace std::chrono;
+  static const steady_clock::time_point start = steady_clock::now();
+  return (uint64_t)duration_cast<nanoseconds>(steady_clock::now() - start).count();
+}
+
+uint32_t halMicros() { return (uint32_t)(nowNs() / 1000); }
+uint32_t halCycles() { return (uint32_t)nowNs(); }
+uint32_t halCpuMhz() { return 1000; }
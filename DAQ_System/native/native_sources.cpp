@@ -0,0 +1,172 @@
+#include "native_sources.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "crc16.h"
+#include "frame_packet.h"
+
+static inline uint32_t lcg(uint32_t& s) {
+  s = s * 1664525u + 1013904223u;
+  return s >> 16;
+}
+
+// ===================== Synthetic =====================
+bool SyntheticAdcSource::begin(ProfileId id) {
+  id_ = id;
+  idx_ = 0;
+  rng_ = seed_;
+  return true;
+}
+
+size_t SyntheticAdcSource::read(AdcRow* rows, size_t maxRows) {
+  const ProfileInfo& prof = PROFILES[id_];
+  for (size_t i = 0; i < maxRows; i++) {
+    AdcRow& r = rows[i];
+    r.idx = idx_;
+    r.t_us = (uint32_t)(((uint64_t)idx_ * 1000000u) / prof.adcHz);
+    r.profile = id_;
+    r.flags = 0;
+    const double t = (double)idx_ / prof.adcHz;
+    for (size_t c = 0; c < ADC_CH; c++) {
+      const double s = 2048.0 + 1200.0 * sin(2.0 * M_PI * (3.0 + 2.0 * c) * t + c);
+      const int v = (int)s + (int)(lcg(rng_) % 17) - 8;
+      r.adc[c] = (uint16_t)(c < prof.adcCh ? (v < 0 ? 0 : (v > 4095 ? 4095 : v)) : 0);
+    }
+    idx_++;
+  }
+  return maxRows;
+}
+
+SyntheticImuSource::SyntheticImuSource(uint32_t imuHz, uint32_t frameHz, uint32_t seed)
+    : imuHz_(imuHz), frameHz_(frameHz), rng_(seed) {}
+
+uint32_t SyntheticImuSource::read(ImuSnapshot& snap) {
+  // publications due by the time of this read
+  const uint32_t due = (uint32_t)(((uint64_t)reads_ * imuHz_) / frameHz_) + 1;
+  const uint32_t frameUs = (uint32_t)(((uint64_t)reads_ * 1000000u) / frameHz_);
+  reads_++;
+
+  if (due != seq_) {
+    seq_ = due;
+    for (size_t d = 0; d < IMU_COUNT; d++) {
+      sample_t* v = &snap_.v[d * IMU_CH_PER];
+      for (size_t k = 0; k < 6; k++) v[k] = (sample_t)((int)(lcg(rng_) % 2001) - 1000); // acc, gyro
+      if (seq_ % (IMU_HZ / MAG_HZ) == 1) {
+        for (size_t k = 6; k < 9; k++) v[k] = (sample_t)((int)(lcg(rng_) % 401) - 200);
+        snap_.t_mag_us[d] = frameUs;
+      }
+      snap_.t_us[d] = frameUs;
+    }
+  }
+  snap = snap_;
+  return seq_;
+}
+
+// ===================== Replay =====================
+bool RecordingSource::load(const char* path) {
+  FILE* f = fopen(path, "rb");
+  if (f == nullptr) return false;
+  std::vector<uint8_t> buf;
+  uint8_t chunk[65536];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) buf.insert(buf.end(), chunk, chunk + n);
+  fclose(f);
+
+  frames_.clear();
+  size_t pos = 0;
+  while (pos + FRAME_PROFILE_OFFSET < buf.size()) {
+    const uint8_t* p = &buf[pos];
+    const uint8_t id = p[FRAME_PROFILE_OFFSET];
+    if (p[0] != (uint8_t)(SYNC_WORD & 0xFF) || p[1] != (uint8_t)(SYNC_WORD >> 8) || p[2] != PKT_VER ||
+        p[3] != PKT_TYPE_FRAME || id >= PROFILE_COUNT || pos + PROFILES[id].frameBytes > buf.size()) {
+      pos++;
+      continue;
+    }
+
+    bool ok = false;
+    withProfile(id, [&](auto prof) {
+      using P = decltype(prof);
+      ProfilePacket<P> pk;
+      memcpy(&pk, p, sizeof(pk));
+      if (pk.crc16 != crc16_ccitt(p, sizeof(pk) - sizeof(pk.crc16))) return;
+
+      Frame fr{};
+      fr.t_us = (uint32_t)pk.t_us; // rows carry micros(), as on the device
+      fr.adcBaseIdx = pk.adc_base_idx;
+      fr.profile = P::ID;
+      fr.flags = pk.flags;
+      for (size_t i = 0; i < P::ADC_BLOCK; i++) memcpy(fr.adc[i], pk.adc[i], sizeof(pk.adc[i]));
+      memcpy(fr.imu, pk.imu, sizeof(fr.imu));
+      fr.imuSeq = pk.imu_seq;
+      memcpy(fr.imuDt, pk.imu_dt, sizeof(fr.imuDt));
+      frames_.push_back(fr);
+      ok = true;
+    });
+    pos += ok ? PROFILES[id].frameBytes : 1;
+  }
+  return true;
+}
+
+size_t RecordingSource::frameCount(ProfileId id) const {
+  size_t n = 0;
+  for (const Frame& f : frames_) n += f.profile == id;
+  return n;
+}
+
+bool RecordingSource::begin(ProfileId id) {
+  id_ = id;
+  frame_ = 0;
+  row_ = 0;
+  last_ = 0;
+  return frameCount(id) > 0;
+}
+
+size_t RecordingSource::read(AdcRow* rows, size_t maxRows) {
+  const size_t block = PROFILES[id_].adcBlock;
+  size_t n = 0;
+  while (n < maxRows) {
+    while (frame_ < frames_.size() && frames_[frame_].profile != id_) frame_++;
+    if (frame_ == frames_.size()) break;
+
+    const Frame& f = frames_[frame_];
+    AdcRow& r = rows[n++];
+    r.idx = f.adcBaseIdx + (uint32_t)row_;
+    r.t_us = f.t_us + (uint32_t)((row_ * 1000000u) / PROFILES[id_].adcHz);
+    r.profile = id_;
+    r.flags = row_ == 0 ? (uint8_t)(f.flags & FRAME_FLAG_ADC_LATE) : 0; // the frame gets it back
+    memcpy(r.adc, f.adc[row_], sizeof(r.adc));
+    last_ = frame_;
+    if (++row_ == block) {
+      row_ = 0;
+      frame_++;
+    }
+  }
+  return n;
+}
+
+uint32_t RecordingSource::read(ImuSnapshot& snap) {
+  if (frames_.empty()) return 0;
+  const Frame& f = frames_[last_];
+  memcpy(snap.v, f.imu, sizeof(snap.v));
+  // unknown capture times become a time 1s old, which frameSeal() re-encodes
+  // as IMU_DT_INVALID
+  auto capture = [&](int16_t dt) -> uint32_t {
+    return dt == IMU_DT_INVALID ? f.t_us - 1000000u : f.t_us + dt * (int32_t)IMU_DT_UNIT_US;
+  };
+  for (size_t d = 0; d < IMU_COUNT; d++) {
+    snap.t_us[d] = capture(f.imuDt[d][0]);
+    snap.t_mag_us[d] = capture(f.imuDt[d][1]);
+  }
+  snap.flags = f.flags & FRAME_FLAG_IMU_LATE;
+  return f.imuSeq;
+}
+
+// ===================== Transport =====================
+size_t MemoryTransport::write(const uint8_t* data, size_t len) {
+  bytes_.insert(bytes_.end(), data, data + len);
+  stats_.bytes += (uint32_t)len;
+  stats_.writes++;
+  return len;
+}
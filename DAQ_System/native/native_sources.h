@@ -0,0 +1,99 @@
+// native_sources.h
+// Host implementations of the hal.h seams for the native harness: synthetic
+// ADC / IMU streams, replay of a recording, and an in-memory transport.
+
+#ifndef NATIVE_SOURCES_H
+#define NATIVE_SOURCES_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "hal.h"
+#include "transport.h"
+
+// ===================== Synthetic =====================
+// One sine per channel (different frequency and phase) plus a little LCG
+// noise, at the profile's ADC rate. Deterministic for a given seed.
+class SyntheticAdcSource : public AdcSource {
+public:
+  explicit SyntheticAdcSource(uint32_t seed = 1) : seed_(seed) {}
+
+  bool begin(ProfileId id) override;
+  size_t read(AdcRow* rows, size_t maxRows) override;
+
+private:
+  uint32_t seed_;
+  uint32_t rng_ = 1;
+  uint32_t idx_ = 0;
+  ProfileId id_ = PROFILE_BALANCED;
+};
+
+// New IMU values at imuHz, read once per frame at frameHz: the publication
+// count repeats between samples like imuCache does on the device.
+class SyntheticImuSource : public ImuSource {
+public:
+  SyntheticImuSource(uint32_t imuHz, uint32_t frameHz, uint32_t seed = 2);
+
+  uint32_t read(ImuSnapshot& snap) override;
+
+private:
+  ImuSnapshot snap_{};
+  uint32_t imuHz_;
+  uint32_t frameHz_;
+  uint32_t rng_;
+  uint32_t reads_ = 0;
+  uint32_t seq_ = 0;
+};
+
+// ===================== Replay =====================
+// Rows and IMU snapshots of the raw frames (PKT_TYPE_FRAME, current PKT_VER)
+// in a recording (recorder.h) or a raw link capture; other packets are
+// skipped. read() hands out whole frames when asked for a frame's worth of
+// rows; read(ImuSnapshot&) returns the IMU block of the frame the last row
+// came from. Rows keep their recorded sample index.
+class RecordingSource : public AdcSource, public ImuSource {
+public:
+  // Returns false if the file cannot be read.
+  bool load(const char* path);
+  size_t frameCount(ProfileId id) const;
+
+  bool begin(ProfileId id) override;
+  size_t read(AdcRow* rows, size_t maxRows) override;
+  uint32_t read(ImuSnapshot& snap) override;
+
+private:
+  struct Frame {
+    uint32_t t_us;
+    uint32_t adcBaseIdx;
+    uint8_t  profile;
+    uint8_t  flags;
+    uint16_t adc[PROFILE_MAX_BLOCK][ADC_CH];
+    int16_t  imu[IMU_CH];
+    uint16_t imuSeq;
+    int16_t  imuDt[IMU_COUNT][2];
+  };
+
+  std::vector<Frame> frames_;
+  ProfileId id_ = PROFILE_BALANCED;
+  size_t frame_ = 0;     // next frame to read rows from
+  size_t row_ = 0;       // next row in it
+  size_t last_ = 0;      // frame of the last row handed out
+};
+
+// ===================== Transport =====================
+// Collects everything written; read() never returns input.
+class MemoryTransport : public Transport {
+public:
+  bool begin() override { return true; }
+  size_t write(const uint8_t* data, size_t len) override;
+  size_t read(uint8_t*, size_t, uint32_t) override { return 0; }
+  const char* name() const override { return "memory"; }
+
+  std::vector<uint8_t>& bytes() { return bytes_; }
+
+private:
+  std::vector<uint8_t> bytes_;
+};
+
+#endif // NATIVE_SOURCES_H
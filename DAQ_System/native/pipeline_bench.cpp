@@ -0,0 +1,361 @@
+// pipeline_bench.cpp
+// Native benchmark and replay check for the acquisition pipeline: the device
+// code paths (pipeline.h, frame_codec, crc16) fed from the hal.h sources at
+// full speed. Build from the repository root:
+//
+//   g++ -O2 -std=c++17 -IDAQ_System/include -IDAQ_System/native -Ihost_decoder
+//       DAQ_System/native/*.cpp DAQ_System/src/frame_codec.cpp DAQ_System/src/dsp_kernels.cpp
+//       host_decoder/frame_decoder.cpp -o daq_bench
+//   ./daq_bench [-n frames] [-p balanced|emg|low_power] [recording.bin]
+//
+// Per profile, rows from a synthetic source (or the raw frames of a recording)
+// go through the stages below; each reports frames/s and ns/frame:
+//
+//   pack      FrameAssembler + frameSeal, as packerTask builds a frame
+//   crc       CRC16 of each sealed frame (checked against crc16)
+//   compress  FrameEncoder (DAQ_TX_COMPRESS)
+//   decode    host FrameDecoder over the raw and the compressed link streams
+//
+// Both decoded streams must give back exactly the packed rows, the compressed
+// one also with a frame lost between keyframes (checkCompressedLoss); the
+// packer wake-up must follow frames that restart after skipped sample indices
+// (checkSkippedIndices), and imuTimeOffset() must pass its edge cases. The
+// exit status is 1 if not, so the harness doubles as an off-target replay test.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "frame_codec.h"
+#include "frame_decoder.h"
+#include "hal.h"
+#include "native_sources.h"
+#include "pipeline.h"
+
+constexpr size_t DEFAULT_FRAMES = 20000;
+constexpr size_t LAP_FRAMES     = 1024;   // timed per lap: the 32-bit clock wraps after ~4s natively
+constexpr size_t READ_CHUNK     = 4096;   // decoder input per call, like a serial read
+
+static const char* const PROFILE_NAMES[PROFILE_COUNT] = {"balanced", "emg", "low_power"};
+
+static inline uint64_t cyclesToNs(uint32_t c) {
+  return (uint64_t)c * 1000 / halCpuMhz();
+}
+
+// Run f(begin, end) over [0, count) in laps and return the total time in ns.
+template <class F>
+static uint64_t timeLaps(size_t count, size_t lap, F&& f) {
+  uint64_t ns = 0;
+  for (size_t b = 0; b < count; b += lap) {
+    const size_t e = b + lap < count ? b + lap : count;
+    const uint32_t start = halCycles();
+    f(b, e);
+    ns += cyclesToNs(halCycles() - start);
+  }
+  return ns;
+}
+
+static void report(const char* profile, const char* stage, size_t frames, uint64_t ns, const char* extra = "") {
+  const double perFrame = frames ? (double)ns / frames : 0.0;
+  const double perSec = ns ? frames * 1e9 / ns : 0.0;
+  printf("%-10s %-18s %12.0f frames/s %9.1f ns/frame%s\n", profile, stage, perSec, perFrame, extra);
+}
+
+// Decode stream into rows; returns the decode time in ns.
+static uint64_t decodeStream(const std::vector<uint8_t>& stream, std::vector<uint32_t>& index,
+                             std::vector<float>& values, size_t& rows) {
+  FrameDecoder dec;
+  RowColumns out{index.data(), values.data(), index.size(), 0};
+  const size_t chunks = (stream.size() + READ_CHUNK - 1) / READ_CHUNK;
+  const uint64_t ns = timeLaps(chunks, 64, [&](size_t b, size_t e) {
+    for (size_t c = b; c < e; c++) {
+      const size_t off = c * READ_CHUNK;
+      const size_t len = stream.size() - off < READ_CHUNK ? stream.size() - off : READ_CHUNK;
+      dec.decode(&stream[off], len, out);
+    }
+  });
+  rows = out.count;
+  return ns;
+}
+
+// Rows of frames in packed that differ from the decoded ones.
+template <class P>
+static size_t compareRows(const std::vector<ProfilePacket<P>>& packed, const std::vector<uint32_t>& index,
+                          const std::vector<float>& values, size_t rows) {
+  if (rows != packed.size() * P::ADC_BLOCK) return packed.size() * P::ADC_BLOCK;
+  size_t bad = 0;
+  for (size_t f = 0; f < packed.size(); f++) {
+    const ProfilePacket<P>& p = packed[f];
+    for (size_t i = 0; i < P::ADC_BLOCK; i++) {
+      const size_t r = f * P::ADC_BLOCK + i;
+      const float* v = &values[r * ROW_VALUES];
+      bool ok = index[r] == p.adc_base_idx + i;
+      for (size_t c = 0; c < P::ADC_CH; c++) ok &= v[c] == (float)p.adc[i][c];
+      for (size_t k = 0; k < IMU_CH; k++) ok &= v[ADC_CH + k] == (float)(p.imu[k] / (double)IMU_SCALE);
+      bad += !ok;
+    }
+  }
+  return bad;
+}
+
+// imuTimeOffset() edge cases: rounding, saturation, and a never-captured time
+// of 0 before and after the 32-bit clock wraps.
+static bool checkImuOffsets() {
+  struct Case { uint32_t captureUs, frameUs; int16_t dt; };
+  static const Case CASES[] = {
+      {1000, 1000, 0},
+      {1004, 1000, 0},
+      {1005, 1000, 1},
+      {995, 1000, -1},
+      {994, 1000, -1},
+      {0xFFFFFFF6u, 0, -1},                 // across the wrap
+      {1000, 1000 + 327670, -32767},
+      {1000, 1000 + 327680, IMU_DT_INVALID}, // too old
+      {1000 + 400000, 1000, INT16_MAX},
+      {0, 0, IMU_DT_INVALID},                 // never captured
+      {0, 5000, IMU_DT_INVALID},
+      {0, 0xFFFFF000u, IMU_DT_INVALID},
+  };
+  bool ok = true;
+  for (const Case& c : CASES) {
+    const int16_t dt = imuTimeOffset(c.captureUs, c.frameUs);
+    if (dt != c.dt) {
+      printf("imuTimeOffset(%u, %u) = %d, expected %d\n", (unsigned)c.captureUs, (unsigned)c.frameUs, dt, c.dt);
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+// Skipped sample indices (missed periods, a lost SPI conversion, DMA frames
+// the driver dropped) and a row lost to a full ring: the sampler's
+// BlockTracker must complete a block on exactly the rows FrameAssembler
+// completes a frame on, also where frames no longer start at a multiple of
+// P::ADC_BLOCK, and every frame must hold the rows its adc_base_idx names.
+// Returns the rows that break this; unaligned counts the frames that complete
+// off the index grid.
+template <class P>
+static size_t checkSkippedIndices(const std::vector<AdcRow>& rows, size_t& unaligned) {
+  struct Skip { size_t at, by; };
+  static const Skip SKIPS[] = {{7, 1}, {23, 3}, {41, 2 * P::ADC_BLOCK}, {58, 1}, {77, P::ADC_BLOCK - 1}};
+  const size_t lostRow = 64; // pushed to a full ring: never reaches the packer, no index skip
+  const size_t n = rows.size() < 200 ? rows.size() : 200;
+
+  FrameAssembler<P> assembler;
+  BlockTracker<P> blocks;
+  ProfilePacket<P> p;
+  std::vector<uint32_t> frameIdx; // indices of the rows in the frame being built
+  uint32_t idx = 0;
+  size_t skip = 0, bad = 0;
+  for (size_t r = 0; r < n; r++) {
+    if (skip < sizeof(SKIPS) / sizeof(SKIPS[0]) && SKIPS[skip].at == r) idx += (uint32_t)SKIPS[skip++].by;
+    AdcRow row = rows[r];
+    row.idx = idx++;
+    if (r == lostRow) continue;
+
+    if (assembler.starts(row)) frameIdx.clear();
+    frameIdx.push_back(row.idx);
+    const bool complete = assembler.add(row, p);
+    bad += complete != blocks.add(row.idx);
+    if (!complete) continue;
+    unaligned += (row.idx + 1) % P::ADC_BLOCK != 0;
+    for (size_t i = 0; i < P::ADC_BLOCK; i++) {
+      bad += frameIdx.size() != P::ADC_BLOCK || frameIdx[i] != p.adc_base_idx + i;
+    }
+  }
+  return bad;
+}
+
+// Link loss between keyframes: drop compressed frame d (every d of the first
+// keyframe interval in turn) and decode the rest. IMU values must match the
+// packed frames, or be NaN where a field was omitted after the loss, and be
+// complete again a keyframe interval after it. Returns the rows that break this.
+template <class P>
+static size_t checkCompressedLoss(const std::vector<ProfilePacket<P>>& packed, size_t& unknown) {
+  const size_t frames = 2 * COMPRESS_KEYFRAME_FRAMES + 1;
+  if (packed.size() < frames) return 0;
+  std::vector<uint32_t> index(frames * P::ADC_BLOCK);
+  std::vector<float> values(frames * P::ADC_BLOCK * ROW_VALUES);
+  size_t bad = 0;
+  for (size_t d = 1; d < COMPRESS_KEYFRAME_FRAMES; d++) {
+    FrameEncoder encoder;
+    std::vector<uint8_t> stream;
+    uint8_t buf[COMPRESSED_MAX_BYTES];
+    for (size_t f = 0; f < frames; f++) {
+      const size_t len = encoder.encode((const uint8_t*)&packed[f], buf);
+      if (f != d) stream.insert(stream.end(), buf, buf + len);
+    }
+    size_t rows = 0;
+    decodeStream(stream, index, values, rows);
+    if (rows != (frames - 1) * P::ADC_BLOCK) return packed.size() * P::ADC_BLOCK;
+
+    size_t r = 0;
+    for (size_t f = 0; f < frames; f++) {
+      if (f == d) continue;
+      const ProfilePacket<P>& p = packed[f];
+      for (size_t i = 0; i < P::ADC_BLOCK; i++, r++) {
+        const float* v = &values[r * ROW_VALUES + ADC_CH];
+        bool ok = true;
+        for (size_t k = 0; k < IMU_CH; k++) {
+          if (v[k] != v[k]) { // NaN: only between the loss and the next keyframe
+            ok &= f > d && f < d + COMPRESS_KEYFRAME_FRAMES;
+            unknown++;
+          } else {
+            ok &= v[k] == (float)(p.imu[k] / (double)IMU_SCALE);
+          }
+        }
+        bad += !ok;
+      }
+    }
+  }
+  return bad;
+}
+
+template <class P>
+static bool runProfile(AdcSource& adc, ImuSource& imu, size_t frames) {
+  using Packet = ProfilePacket<P>;
+  const char* name = PROFILE_NAMES[P::ID];
+
+  // ---------------- Source (untimed) ----------------
+  std::vector<AdcRow> rows;
+  std::vector<ImuSnapshot> snaps;
+  std::vector<uint16_t> imuSeqs;
+  rows.reserve(frames * P::ADC_BLOCK);
+  AdcRow block[P::ADC_BLOCK];
+  while (snaps.size() < frames && adc.read(block, P::ADC_BLOCK) == P::ADC_BLOCK) {
+    rows.insert(rows.end(), block, block + P::ADC_BLOCK);
+    ImuSnapshot s;
+    imuSeqs.push_back((uint16_t)imu.read(s));
+    snaps.push_back(s);
+  }
+  const size_t n = snaps.size();
+  if (n == 0) return true;
+
+  // ---------------- Pack ----------------
+  std::vector<Packet> packed(n);
+  FrameAssembler<P> assembler;
+  WideMicros clock;
+  size_t built = 0;
+  const uint64_t packNs = timeLaps(n, LAP_FRAMES, [&](size_t b, size_t e) {
+    for (size_t r = b * P::ADC_BLOCK; r < e * P::ADC_BLOCK; r++) {
+      assembler.starts(rows[r]);
+      if (!assembler.add(rows[r], packed[built])) continue;
+      frameSeal<P>(packed[built], (uint32_t)built, clock.extend(assembler.startUs()), assembler.flags(), imuSeqs[built],
+                   snaps[built]);
+      built++;
+    }
+  });
+  packed.resize(built);
+  report(name, "pack", built, packNs);
+
+  // ---------------- CRC ----------------
+  size_t crcBad = 0;
+  const uint64_t crcNs = timeLaps(built, LAP_FRAMES, [&](size_t b, size_t e) {
+    for (size_t f = b; f < e; f++) {
+      const uint8_t* p = (const uint8_t*)&packed[f];
+      crcBad += crc16_ccitt(p, sizeof(Packet) - sizeof(uint16_t)) != packed[f].crc16;
+    }
+  });
+  report(name, "crc", built, crcNs);
+
+  // ---------------- Compress ----------------
+  // Frames go to the link in txTask-sized bursts; the raw stream is what an
+  // uncompressed build sends.
+  MemoryTransport rawLink, compLink;
+  FrameEncoder encoder;
+  uint8_t burst[TX_BATCH_MAX_FRAMES * COMPRESSED_MAX_BYTES];
+  for (size_t f = 0; f < built; f += TX_BATCH_MAX_FRAMES) {
+    const size_t k = built - f < TX_BATCH_MAX_FRAMES ? built - f : TX_BATCH_MAX_FRAMES;
+    rawLink.write((const uint8_t*)&packed[f], k * sizeof(Packet));
+  }
+  size_t compBytes = 0;
+  const uint64_t compNs = timeLaps(built, TX_BATCH_MAX_FRAMES, [&](size_t b, size_t e) {
+    size_t len = 0;
+    for (size_t f = b; f < e; f++) len += encoder.encode((const uint8_t*)&packed[f], &burst[len]);
+    compLink.write(burst, len); // inside the lap, but a memcpy next to the encode
+    compBytes += len;
+  });
+  char extra[48];
+  snprintf(extra, sizeof(extra), "  (%.1f of %zu bytes)", built ? (double)compBytes / built : 0.0, sizeof(Packet));
+  report(name, "compress", built, compNs, extra);
+
+  // ---------------- Decode ----------------
+  std::vector<uint32_t> index(built * P::ADC_BLOCK);
+  std::vector<float> values(built * P::ADC_BLOCK * ROW_VALUES);
+  size_t decoded = 0;
+  const uint64_t rawNs = decodeStream(rawLink.bytes(), index, values, decoded);
+  const size_t rawBad = compareRows<P>(packed, index, values, decoded);
+  report(name, "decode raw", built, rawNs);
+
+  const uint64_t cNs = decodeStream(compLink.bytes(), index, values, decoded);
+  const size_t compBad = compareRows<P>(packed, index, values, decoded);
+  report(name, "decode compressed", built, cNs);
+
+  size_t unaligned = 0;
+  const size_t skipBad = checkSkippedIndices<P>(rows, unaligned);
+  printf("%-10s %-18s %zu rows wrong, %zu frames completed off the index grid\n", name, "skipped indices",
+         skipBad, unaligned);
+
+  size_t unknown = 0;
+  const size_t lossBad = checkCompressedLoss<P>(packed, unknown);
+  printf("%-10s %-18s %zu rows wrong, %zu IMU values unknown until a keyframe\n", name, "decode after loss",
+         lossBad, unknown);
+
+  if (crcBad || rawBad || compBad || lossBad || skipBad || !unaligned) {
+    printf("%-10s MISMATCH: %zu crc, %zu raw rows, %zu compressed rows, %zu rows after loss, %zu skipped-index rows\n",
+           name, crcBad, rawBad, compBad, lossBad, skipBad);
+    return false;
+  }
+  return true;
+}
+
+static void usage(const char* argv0) {
+  fprintf(stderr, "usage: %s [-n frames] [-p balanced|emg|low_power] [recording.bin]\n", argv0);
+  exit(2);
+}
+
+int main(int argc, char** argv) {
+  size_t frames = DEFAULT_FRAMES;
+  int only = -1;
+  const char* recording = nullptr;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+      frames = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+      ++i;
+      for (int id = 0; id < PROFILE_COUNT; id++) {
+        if (strcmp(argv[i], PROFILE_NAMES[id]) == 0) only = id;
+      }
+      if (only < 0) usage(argv[0]);
+    } else if (argv[i][0] != '-' && recording == nullptr) {
+      recording = argv[i];
+    } else {
+      usage(argv[0]);
+    }
+  }
+
+  RecordingSource replay;
+  if (recording && !replay.load(recording)) {
+    fprintf(stderr, "cannot read %s\n", recording);
+    return 2;
+  }
+
+  bool ok = checkImuOffsets();
+  for (int id = 0; id < PROFILE_COUNT; id++) {
+    if (only >= 0 && id != only) continue;
+    withProfile((uint8_t)id, [&](auto prof) {
+      using P = decltype(prof);
+      if (recording) {
+        if (replay.begin(P::ID)) ok &= runProfile<P>(replay, replay, frames);
+        return;
+      }
+      SyntheticAdcSource adc;
+      SyntheticImuSource imu(P::IMU_HZ, P::ADC_HZ / P::ADC_BLOCK);
+      adc.begin(P::ID);
+      ok &= runProfile<P>(adc, imu, frames);
+    });
+  }
+  return ok ? 0 : 1;
+}
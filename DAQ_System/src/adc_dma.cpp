@@ -0,0 +1,235 @@
+#include <Arduino.h>
+#include <esp_adc/adc_continuous.h>
+#include "adc_dma.h"
+#include "fir_decimator.h"
+
+#if DAQ_ADC_DMA
+
+constexpr size_t MAX_FRAME_BYTES = ADC_DMA_MAX_FRAME_RESULTS * SOC_ADC_DIGI_RESULT_BYTES;
+
+constexpr bool frameBytesAligned() {
+  for (size_t i = 0; i < PROFILE_COUNT; i++) {
+    if ((adcDmaFrameResults(PROFILES[i]) * SOC_ADC_DIGI_RESULT_BYTES) % SOC_ADC_DIGI_DATA_BYTES_PER_CONV) return false;
+  }
+  return true;
+}
+
+static_assert(frameBytesAligned(), "DMA frame must be a whole number of conversions");
+static_assert(ADC_CH <= SOC_ADC_PATT_LEN_MAX, "too many ADC channels for the pattern table");
+
+// Decimator taps per profile, generated at compile time.
+template <ProfileId Id>
+using AdcFirTaps = FirDecimatorTaps<adcDmaOversample(PROFILES[Id]), ADC_FIR_TAPS_PER_PHASE>;
+
+struct AdcFirKernel {
+  const int16_t* taps;
+  uint16_t len;
+};
+
+static AdcFirKernel firKernel(ProfileId id) {
+  AdcFirKernel k = {};
+  withProfile(id, [&](auto prof) {
+    using T = AdcFirTaps<decltype(prof)::ID>;
+    k = AdcFirKernel{T::taps.data(), (uint16_t)T::N};
+  });
+  return k;
+}
+
+static_assert(ADC_FIR_TAPS_PER_PHASE % 4 == 0, "ESP-DSP dot product needs a multiple of 4 taps");
+static_assert(AdcFirTaps<PROFILE_BALANCED>::N <= ADC_FIR_MAX_TAPS &&
+              AdcFirTaps<PROFILE_EMG>::N <= ADC_FIR_MAX_TAPS &&
+              AdcFirTaps<PROFILE_LOW_POWER>::N <= ADC_FIR_MAX_TAPS, "ADC_FIR_MAX_TAPS too small");
+
+static adc_continuous_handle_t adcHandle = nullptr;
+
+// current configuration (set by adcDmaBegin, read by adcDmaRead on the same task)
+static uint8_t  numCh = 0;
+static uint32_t oversample = 1;
+static uint32_t rowUs = 0;
+static uint32_t frameUs = 0;
+static uint32_t firDelayUs = 0;            // decimator group delay
+static AdcFirKernel kernel = {};
+static size_t   frameBytes = 0;
+
+// column in AdcRow::adc for each ADC1 channel number (0xFF = not scanned)
+static uint8_t chanToCol[SOC_ADC_CHANNEL_NUM(ADC_UNIT_1)];
+
+// written by the conversion-done and pool-overflow ISRs, read by adcDmaRead().
+// The driver signals conversion done before it queues the frame, so a frame it
+// then drops is in both counts.
+static volatile uint32_t framesDone = 0;
+static volatile uint32_t framesDropped = 0;
+static volatile uint32_t lastFrameDoneUs = 0;
+static uint32_t framesRead = 0;             // whole frames consumed
+static uint32_t partialBytes = 0;           // of the next frame, after a short read
+static uint32_t droppedSeen = 0;
+
+static uint32_t droppedResults = 0;
+
+// Decoder state survives across reads so a scan split over two DMA frames is
+// still assembled correctly and the filters run continuously; reset when the
+// configuration changes.
+static uint16_t scan[ADC_CH];
+static FirDecimator<ADC_FIR_MAX_TAPS> fir[ADC_CH];
+static bool    firPrimed = false;
+static uint8_t  col = 0;
+static uint32_t scans = 0;
+
+static uint8_t dmaBuf[MAX_FRAME_BYTES] __attribute__((aligned(4)));
+
+static bool IRAM_ATTR onConvDone(adc_continuous_handle_t, const adc_continuous_evt_data_t*, void*) {
+  lastFrameDoneUs = (uint32_t)esp_timer_get_time();
+  framesDone = framesDone + 1;
+  return false;
+}
+
+static bool IRAM_ATTR onPoolOvf(adc_continuous_handle_t, const adc_continuous_evt_data_t*, void*) {
+  framesDropped = framesDropped + 1;
+  return false;
+}
+
+bool adcDmaBegin(ProfileId id) {
+  const ProfileInfo& prof = PROFILES[id];
+  if (adcHandle) {
+    adc_continuous_stop(adcHandle);
+    adc_continuous_deinit(adcHandle);
+    adcHandle = nullptr;
+  }
+
+  numCh = prof.adcCh;
+  oversample = adcDmaOversample(prof);
+  rowUs = 1000000UL / prof.adcHz;
+  frameUs = rowUs * adcDmaFrameRows(prof);
+  frameBytes = adcDmaFrameResults(prof) * SOC_ADC_DIGI_RESULT_BYTES;
+  kernel = firKernel(id);
+  firDelayUs = adcDmaFirDelayUs(prof);
+
+  firPrimed = false;
+  col = 0;
+  scans = 0;
+  framesDone = 0;
+  framesDropped = 0;
+  framesRead = 0;
+  partialBytes = 0;
+  droppedSeen = 0;
+
+  adc_continuous_handle_cfg_t handleCfg = {};
+  // same time cushion whatever the DMA frame length
+  handleCfg.max_store_buf_size = frameBytes * ADC_DMA_FRAMES_BUFFERED * (prof.adcBlock / adcDmaFrameRows(prof));
+  handleCfg.conv_frame_size = frameBytes;
+  if (adc_continuous_new_handle(&handleCfg, &adcHandle) != ESP_OK) return false;
+
+  memset(chanToCol, 0xFF, sizeof(chanToCol));
+
+  adc_digi_pattern_config_t pattern[ADC_CH] = {};
+  for (size_t c = 0; c < numCh; c++) {
+    adc_unit_t unit;
+    adc_channel_t chan;
+    if (adc_continuous_io_to_channel(ADC_PINS[c], &unit, &chan) != ESP_OK || unit != ADC_UNIT_1) {
+      return false;
+    }
+    pattern[c].atten = ADC_ATTEN_DB_12; // same range as analogRead() default
+    pattern[c].channel = (uint8_t)chan;
+    pattern[c].unit = ADC_UNIT_1;
+    pattern[c].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+    chanToCol[chan] = (uint8_t)c;
+  }
+
+  adc_continuous_config_t digCfg = {};
+  digCfg.sample_freq_hz = adcDmaScanHz(prof);
+  digCfg.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+  digCfg.format = ADC_DIGI_OUTPUT_FORMAT_TYPE1;
+  digCfg.pattern_num = numCh;
+  digCfg.adc_pattern = pattern;
+  if (adc_continuous_config(adcHandle, &digCfg) != ESP_OK) return false;
+
+  adc_continuous_evt_cbs_t cbs = {};
+  cbs.on_conv_done = onConvDone;
+  cbs.on_pool_ovf = onPoolOvf;
+  if (adc_continuous_register_event_callbacks(adcHandle, &cbs, nullptr) != ESP_OK) return false;
+
+  return adc_continuous_start(adcHandle) == ESP_OK;
+}
+
+size_t adcDmaRead(AdcRow* rows, size_t maxRows, uint32_t timeoutMs, AdcDmaReadInfo& info) {
+  info = AdcDmaReadInfo{};
+  uint32_t got = 0;
+  if (adc_continuous_read(adcHandle, dmaBuf, frameBytes, &got, timeoutMs) != ESP_OK) return 0;
+
+  uint32_t done, dropped, doneUs;
+  do {
+    done = framesDone;
+    dropped = framesDropped;
+    doneUs = lastFrameDoneUs;
+  } while (done != framesDone);
+
+  // Frames dropped since the last read: the ring was full, so they come after
+  // the frames it still held. Those are few (ADC_DMA_FRAMES_BUFFERED packets),
+  // so the gap is placed here, ahead of this frame, and the decimator restarts
+  // rather than filtering across it.
+  const uint32_t lostFrames = dropped - droppedSeen;
+  if (lostFrames) {
+    droppedSeen = dropped;
+    droppedResults += lostFrames * (uint32_t)(frameBytes / SOC_ADC_DIGI_RESULT_BYTES);
+    info.lostRows = lostFrames * (uint32_t)(frameUs / rowUs);
+    firPrimed = false;
+  }
+
+  size_t n = 0;
+  for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= got; i += SOC_ADC_DIGI_RESULT_BYTES) {
+    const adc_digi_output_data_t* r = (const adc_digi_output_data_t*)&dmaBuf[i];
+    const uint32_t chan = r->type1.channel;
+    const uint8_t c = (chan < sizeof(chanToCol)) ? chanToCol[chan] : 0xFF;
+
+    // Out-of-order result: drop the partial scan and wait for column 0.
+    if (c != col) {
+      droppedResults++;
+      col = 0;
+      if (c != 0) continue;
+    }
+
+    scan[col++] = (uint16_t)r->type1.data;
+    if (col < numCh) continue;
+    col = 0;
+
+    if (!firPrimed) {
+      for (size_t ch = 0; ch < numCh; ch++) fir[ch].reset(kernel.len, (int16_t)scan[ch]);
+      firPrimed = true;
+    }
+    for (size_t ch = 0; ch < numCh; ch++) fir[ch].push((int16_t)scan[ch]);
+    if (++scans < oversample) continue;
+    scans = 0;
+
+    if (n < maxRows) {
+      for (size_t ch = 0; ch < numCh; ch++) {
+        const int16_t y = fir[ch].output(kernel.taps);
+        rows[n].adc[ch] = (uint16_t)(y < 0 ? 0 : (y > 4095 ? 4095 : y));
+      }
+      n++;
+    }
+  }
+
+  // Time-stamp from the ISR that completed the newest queued frame: the bytes
+  // still queued behind this read (done - dropped frames were queued) are
+  // that much earlier, frameUs per frame. A short read ends inside a frame.
+  // Each output describes the middle of its filter window, firDelayUs before
+  // its last input.
+  partialBytes += got;
+  framesRead += partialBytes / frameBytes;
+  partialBytes %= frameBytes;
+  const uint32_t behindBytes = (done - dropped - framesRead) * (uint32_t)frameBytes - partialBytes;
+  const uint32_t behindUs = (uint32_t)(((uint64_t)behindBytes * frameUs) / frameBytes);
+  const uint32_t endUs = doneUs - behindUs - firDelayUs;
+  info.lagFrames = behindBytes / (uint32_t)frameBytes;
+  for (size_t k = 0; k < n; k++) {
+    rows[k].t_us = endUs - (uint32_t)(n - 1 - k) * rowUs;
+  }
+
+  return n;
+}
+
+uint32_t adcDmaDroppedResults() {
+  return droppedResults;
+}
+
+#endif // DAQ_ADC_DMA
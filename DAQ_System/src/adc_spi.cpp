@@ -0,0 +1,53 @@
+#include <Arduino.h>
+#include <SPI.h>
+#include "adc_spi.h"
+
+#if DAQ_ADC_SPI
+
+static SPIClass adcBus(VSPI);
+static const SPISettings ADC_SPI_SETTINGS(ADC_SPI_HZ, MSBFIRST, SPI_MODE3); // DOUTA shifts on SCLK falling
+
+bool adcSpiBegin() {
+  pinMode(ADC_SPI_CS, OUTPUT);
+  pinMode(ADC_SPI_CONVST, OUTPUT);
+  pinMode(ADC_SPI_RESET, OUTPUT);
+  pinMode(ADC_SPI_BUSY, INPUT);
+  digitalWrite(ADC_SPI_CS, HIGH);
+  digitalWrite(ADC_SPI_CONVST, HIGH);
+
+  // RESET high >= 50ns, then the first conversion may start
+  digitalWrite(ADC_SPI_RESET, HIGH);
+  delayMicroseconds(1);
+  digitalWrite(ADC_SPI_RESET, LOW);
+  delayMicroseconds(1);
+
+  adcBus.begin(ADC_SPI_SCLK, ADC_SPI_MISO, -1, -1);
+  return true;
+}
+
+bool adcSpiRead(uint16_t adc[ADC_CH]) {
+  // rising CONVST edge samples all channels; BUSY rises within 40ns of it,
+  // well inside the digitalWrite() that follows
+  digitalWrite(ADC_SPI_CONVST, LOW);
+  digitalWrite(ADC_SPI_CONVST, HIGH);
+  const uint32_t start = (uint32_t)micros();
+  while (digitalRead(ADC_SPI_BUSY) == HIGH) {
+    if ((uint32_t)micros() - start > ADC_SPI_BUSY_TIMEOUT_US) return false;
+  }
+
+  uint8_t buf[2 * ADC_CH] = {};
+  adcBus.beginTransaction(ADC_SPI_SETTINGS);
+  digitalWrite(ADC_SPI_CS, LOW);
+  adcBus.transfer(buf, sizeof(buf));
+  digitalWrite(ADC_SPI_CS, HIGH);
+  adcBus.endTransaction();
+
+  // big-endian two's complement -> offset binary -> 12 bits
+  for (size_t c = 0; c < ADC_CH; c++) {
+    const uint16_t code = (uint16_t)((buf[2 * c] << 8) | buf[2 * c + 1]);
+    adc[c] = (uint16_t)((code ^ 0x8000u) >> ADC_SPI_SHIFT);
+  }
+  return true;
+}
+
+#endif // DAQ_ADC_SPI
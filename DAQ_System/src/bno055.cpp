@@ -0,0 +1,42 @@
+// bno055.cpp
+#include "bno055.h"
+#include <string.h>
+
+// register pointer write + repeated start + n-byte read: one bus transaction,
+// decoded as little-endian int16 pairs
+static bool readBlock(TwoWire& wire, uint8_t addr, uint8_t reg, int16_t* v, size_t n) {
+  uint8_t buf[BNO055_AMGQ_BYTES];
+  wire.beginTransmission(addr);
+  wire.write(reg);
+  if (wire.endTransmission(false) != 0) return false;
+  if (wire.requestFrom(addr, (uint8_t)n) != n) return false;
+  if (wire.readBytes(buf, n) != n) return false;
+
+  for (size_t i = 0; i < n / 2; i++) {
+    v[i] = (int16_t)((uint16_t)buf[2 * i] | ((uint16_t)buf[2 * i + 1] << 8));
+  }
+  return true;
+}
+
+bool bno055ReadAmg(TwoWire& wire, uint8_t addr, Bno055Raw& out) {
+  // copied whole since Bno055Raw mirrors the register block
+  static_assert(sizeof(Bno055Raw) == BNO055_AMG_BYTES, "Bno055Raw must mirror the register block");
+  int16_t v[BNO055_AMG_BYTES / 2];
+  if (!readBlock(wire, addr, BNO055_ACC_DATA_X_LSB, v, BNO055_AMG_BYTES)) return false;
+  memcpy(&out, v, sizeof(out));
+  return true;
+}
+
+bool bno055ReadAmgQuat(TwoWire& wire, uint8_t addr, Bno055Raw& out, int16_t quat[4]) {
+  int16_t v[BNO055_AMGQ_BYTES / 2];
+  if (!readBlock(wire, addr, BNO055_ACC_DATA_X_LSB, v, BNO055_AMGQ_BYTES)) return false;
+  memcpy(&out, v, sizeof(out));
+  memcpy(quat, &v[(BNO055_QUA_DATA_W_LSB - BNO055_ACC_DATA_X_LSB) / 2], 4 * sizeof(int16_t));
+  return true;
+}
+
+bool tca9548aSelect(TwoWire& wire, uint8_t muxAddr, uint8_t channel) {
+  wire.beginTransmission(muxAddr);
+  wire.write((uint8_t)(1u << channel));
+  return wire.endTransmission() == 0;
+}
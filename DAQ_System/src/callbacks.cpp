@@ -2,16 +2,21 @@
 #include "callbacks.h"
 
 // The queue handle is defined in main.cpp; declare it here so ISRs can queue events.
-extern QueueHandle_t printQueue;
+extern QueueHandle_t imuTickQueue;
 
 // The sampling task handle is declared in main.cpp; T1 ISR will notify it.
 extern TaskHandle_t samplingTaskHandle;
 
-// Event ID for T2 (printing request)
-static const uint8_t EVT_T2 = 2;
+// ADC tick count; adcTask reads it, so the notification is only a wake-up.
+volatile uint32_t adcTimerTicks = 0;
 
-// Timer 1 ISR: notify the sampling task to perform ADC reads in task context.
+// IMU tick number; the queued value tells imuTask which period it is serving.
+volatile uint32_t imuTimerTicks = 0;
+
+// Timer 1 ISR: count the tick and notify the sampling task to perform ADC
+// reads in task context.
 extern "C" void IRAM_ATTR T1_callback() {
+  adcTimerTicks = adcTimerTicks + 1;
   if (samplingTaskHandle != NULL) {
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
     vTaskNotifyGiveFromISR(samplingTaskHandle, &xHigherPriorityTaskWoken);
@@ -19,11 +24,23 @@ extern "C" void IRAM_ATTR T1_callback() {
   }
 }
 
-// Timer 2 ISR: enqueue a print request id. Use the FromISR variant.
+// Timer 2 ISR: enqueue the IMU tick number. Use the FromISR variant.
 extern "C" void IRAM_ATTR T2_callback() {
-  if (printQueue != NULL) {
+  const uint32_t tick = ++imuTimerTicks;
+  if (imuTickQueue != NULL) {
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-    xQueueSendFromISR(printQueue, &EVT_T2, &xHigherPriorityTaskWoken);
+    xQueueSendFromISR(imuTickQueue, &tick, &xHigherPriorityTaskWoken);
     portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
   }
 }
+
+// esp_timer variants: same work with the task-context calls.
+void T1_task_callback(void*) {
+  adcTimerTicks = adcTimerTicks + 1;
+  if (samplingTaskHandle != NULL) xTaskNotifyGive(samplingTaskHandle);
+}
+
+void T2_task_callback(void*) {
+  const uint32_t tick = ++imuTimerTicks;
+  if (imuTickQueue != NULL) xQueueSend(imuTickQueue, &tick, 0);
+}
@@ -0,0 +1,32 @@
+#include <atomic>
+#include "control.h"
+#include "seqlock.h"
+
+#if DAQ_CONTROL
+
+static SeqLock<ControlSample> mailbox;
+static std::atomic<ControlCallback> callback{nullptr};
+
+void controlSetCallback(ControlCallback cb) {
+  callback.store(cb, std::memory_order_release);
+}
+
+uint32_t controlLatest(ControlSample& out) {
+  ControlSample s;
+  const uint32_t n = mailbox.read(s);
+  if (n) out = s;
+  return n;
+}
+
+void controlPublish(const AdcRow& row, const ImuSnapshot& imu, uint32_t imuSeq) {
+  static ControlSample s; // adcTask stack stays small
+  s.row = row;
+  s.imu = imu;
+  s.imuSeq = imuSeq;
+  mailbox.write(s);
+
+  const ControlCallback cb = callback.load(std::memory_order_acquire);
+  if (cb) cb(s);
+}
+
+#endif // DAQ_CONTROL
@@ -0,0 +1,9 @@
+#include <esp_attr.h>
+#include "crc16.h"
+
+// DRAM rather than flash rodata: the sampling/packing path must not stall on a
+// flash cache miss for every byte it checksums.
+DRAM_ATTR constexpr Crc16Table CRC16_TABLE{};
+
+static_assert(CRC16_TABLE.v[1] == 0x1021, "CRC16 table generation mismatch");
+static_assert(CRC16_TABLE.v[255] == 0x1EF0, "CRC16 table generation mismatch");
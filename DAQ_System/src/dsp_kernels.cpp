@@ -0,0 +1,74 @@
+#include "dsp_kernels.h"
+
+#if DAQ_DSP_BENCH
+
+#include <esp_cpu.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "adc_dma.h"
+
+constexpr int BENCH_ITERS = 1000;
+constexpr size_t BENCH_MAX_N = ADC_FIR_MAX_TAPS;
+
+static int16_t benchA[BENCH_MAX_N] __attribute__((aligned(16)));
+static int16_t benchB[BENCH_MAX_N + 8] __attribute__((aligned(16)));
+static int16_t benchOut[BENCH_MAX_N] __attribute__((aligned(16)));
+static int16_t benchRef[BENCH_MAX_N] __attribute__((aligned(16)));
+
+// Cycles per call of f(), averaged over BENCH_ITERS.
+template <class F>
+static uint32_t benchCycles(F&& f) {
+  const uint32_t start = (uint32_t)esp_cpu_get_cycle_count();
+  for (int i = 0; i < BENCH_ITERS; i++) {
+    f();
+    __asm__ __volatile__("" ::: "memory"); // keep the call inside the loop
+  }
+  return ((uint32_t)esp_cpu_get_cycle_count() - start) / BENCH_ITERS;
+}
+
+static void benchFir(size_t n) {
+  volatile int16_t sink = 0;
+  int32_t maxErr = 0;
+  for (size_t off = 0; off < 8; off++) { // history windows start at any offset
+    const int32_t a = dspFirQ15Scalar(benchA, benchB + off, n);
+    const int32_t b = dspFirQ15(benchA, benchB + off, n);
+    if (abs(a - b) > maxErr) maxErr = abs(a - b);
+  }
+  const uint32_t scalar = benchCycles([&] { sink = dspFirQ15Scalar(benchA, benchB + 1, n); });
+  const uint32_t sel = benchCycles([&] { sink = dspFirQ15(benchA, benchB + 1, n); });
+  (void)sink;
+  printf("dsp fir   n=%3u scalar %5u cyc, selected %5u cyc, max diff %d LSB\n",
+         (unsigned)n, (unsigned)scalar, (unsigned)sel, (int)maxErr);
+}
+
+static void benchDelta(size_t n) {
+  dspDeltaS16Scalar(benchB + 1, benchB, benchRef, n);
+  dspDeltaS16(benchB + 1, benchB, benchOut, n);
+  size_t mismatch = 0;
+  for (size_t i = 0; i < n; i++) mismatch += benchOut[i] != benchRef[i];
+
+  const uint32_t scalar = benchCycles([&] { dspDeltaS16Scalar(benchB + 1, benchB, benchOut, n); });
+  const uint32_t sel = benchCycles([&] { dspDeltaS16(benchB + 1, benchB, benchOut, n); });
+  printf("dsp delta n=%3u scalar %5u cyc, selected %5u cyc, %u mismatches\n",
+         (unsigned)n, (unsigned)scalar, (unsigned)sel, (unsigned)mismatch);
+}
+
+void dspKernelsBenchmark() {
+  // taps: small Q15 values around one large centre tap, so outputs stay in
+  // range; samples: 12-bit noise around mid-scale
+  for (size_t i = 0; i < BENCH_MAX_N; i++) {
+    benchA[i] = (int16_t)(i == BENCH_MAX_N / 2 ? 16384 : (int)(rand() % 256) - 128);
+  }
+  for (size_t i = 0; i < BENCH_MAX_N + 8; i++) {
+    benchB[i] = (int16_t)(2048 + rand() % 256 - 128);
+  }
+
+  printf("dsp kernels: %s\n", DAQ_DSP_ESP_DSP ? "ESP-DSP" : "scalar");
+  for (size_t i = 0; i < PROFILE_COUNT; i++) {
+    const ProfileInfo& p = PROFILES[i];
+    benchFir(ADC_FIR_TAPS_PER_PHASE * adcDmaOversample(p));
+    benchDelta((size_t)(p.adcBlock - 1) * p.adcCh);
+  }
+}
+
+#endif // DAQ_DSP_BENCH
@@ -0,0 +1,111 @@
+#include <string.h>
+#include "crc16.h"
+#include "dsp_kernels.h"
+#include "frame_codec.h"
+
+// LSB-first bit packer; callers write at most 16 bits at a time.
+struct BitWriter {
+  uint8_t* p;
+  uint32_t acc = 0;
+  uint8_t  n = 0;
+
+  explicit BitWriter(uint8_t* out) : p(out) {}
+
+  inline void put(uint32_t v, uint8_t bits) {
+    acc |= v << n;
+    n += bits;
+    while (n >= 8) {
+      *p++ = (uint8_t)acc;
+      acc >>= 8;
+      n -= 8;
+    }
+  }
+
+  inline uint8_t* finish() {
+    if (n) *p++ = (uint8_t)acc;
+    acc = 0;
+    n = 0;
+    return p;
+  }
+};
+
+static inline uint32_t zigzag(int32_t d) {
+  return ((uint32_t)d << 1) ^ (uint32_t)(d >> 31);
+}
+
+static inline uint8_t bitWidth(uint32_t v) {
+  return v ? (uint8_t)(32 - __builtin_clz(v)) : 0;
+}
+
+size_t FrameEncoder::encode(const uint8_t* frame, uint8_t* out, bool omitImu) {
+  size_t n = 0;
+  withProfile(frame[FRAME_PROFILE_OFFSET], [&](auto prof) {
+    using P = decltype(prof);
+    n = encodeAs<P>(*(const ProfilePacket<P>*)frame, out, omitImu);
+  });
+  return n;
+}
+
+template <class P>
+size_t FrameEncoder::encodeAs(const ProfilePacket<P>& in, uint8_t* out, bool omitImu) {
+  CompressedHeader* h = (CompressedHeader*)out;
+  h->sync = in.sync;
+  h->version = in.version;
+  h->type = PKT_TYPE_FRAME_COMPRESSED;
+  h->frame_seq = in.frame_seq;
+  h->t_us = in.t_us;
+  h->adc_base_idx = in.adc_base_idx;
+  h->profile = P::ID;
+  h->flags = in.flags;
+  h->imu_seq = in.imu_seq;
+  memcpy(h->imu_dt, in.imu_dt, sizeof(h->imu_dt));
+  memset(h->imu_mask, 0, sizeof(h->imu_mask));
+
+  // ADC: first sample raw (12 bits), then zigzag deltas at the channel's width.
+  // Samples are 12-bit, so row-to-row deltas of the whole block fit int16.
+  constexpr size_t nDelta = (P::ADC_BLOCK - 1) * P::ADC_CH;
+  int16_t delta[nDelta] __attribute__((aligned(16)));
+  const int16_t* adc = (const int16_t*)(const void*)in.adc;
+  dspDeltaS16(adc + P::ADC_CH, adc, delta, nDelta);
+
+  BitWriter bw(out + sizeof(CompressedHeader));
+  for (size_t ch = 0; ch < P::ADC_CH; ch++) {
+    uint32_t zz[P::ADC_BLOCK];
+    uint32_t maxZz = 0;
+    for (size_t i = 1; i < P::ADC_BLOCK; i++) {
+      zz[i] = zigzag(delta[(i - 1) * P::ADC_CH + ch]);
+      if (zz[i] > maxZz) maxZz = zz[i];
+    }
+    const uint8_t w = bitWidth(maxZz);
+
+    bw.put(in.adc[0][ch] & 0x0FFF, 12);
+    bw.put(w, 4);
+    for (size_t i = 1; i < P::ADC_BLOCK; i++) bw.put(zz[i], w);
+  }
+  uint8_t* p = bw.finish();
+
+  // IMU: only fields that changed (all of them on a keyframe), or none at all
+  // on a degraded frame; the receiver then needs a keyframe next.
+  if (omitImu) {
+    h->imu_mask[COMPRESS_IMU_OMITTED_BIT >> 3] |= (uint8_t)(1u << (COMPRESS_IMU_OMITTED_BIT & 7));
+    sinceKey_ = COMPRESS_KEYFRAME_FRAMES;
+  }
+  const bool key = !omitImu && ((++sinceKey_ >= COMPRESS_KEYFRAME_FRAMES) || (lastProfile_ != P::ID));
+  lastProfile_ = P::ID;
+  if (key) sinceKey_ = 0;
+  for (size_t i = 0; i < IMU_CH && !omitImu; i++) {
+    const int16_t v = in.imu[i];
+    if (!key && v == lastImu_[i]) continue;
+    h->imu_mask[i >> 3] |= (uint8_t)(1u << (i & 7));
+    memcpy(p, &v, sizeof(v));
+    p += sizeof(v);
+    lastImu_[i] = v;
+  }
+
+  const size_t len = (size_t)(p - out) + sizeof(uint16_t);
+  h->len = (uint8_t)len;
+
+  const uint16_t crc = crc16_ccitt(out, len - sizeof(uint16_t));
+  memcpy(p, &crc, sizeof(crc));
+  return len;
+}
@@ -0,0 +1,40 @@
+#include <Arduino.h>
+#include <esp_system.h>
+#include <esp_task_wdt.h>
+#include "health.h"
+
+static std::atomic<TaskHandle_t> taskHandles[STATS_TASKS] = {};
+
+void healthBegin() {
+  esp_task_wdt_config_t cfg = {};
+  cfg.timeout_ms = HEALTH_WDT_TIMEOUT_MS;
+  // keep the idle-task checks the sdkconfig asked for
+#if CONFIG_ESP_TASK_WDT_CHECK_IDLE_TASK_CPU0
+  cfg.idle_core_mask |= 1u << 0;
+#endif
+#if CONFIG_ESP_TASK_WDT_CHECK_IDLE_TASK_CPU1
+  cfg.idle_core_mask |= 1u << 1;
+#endif
+  cfg.trigger_panic = true; // reboot; the next stats packets report ESP_RST_TASK_WDT
+  if (esp_task_wdt_init(&cfg) == ESP_ERR_INVALID_STATE) esp_task_wdt_reconfigure(&cfg);
+}
+
+void healthWatch(StatsTaskId id, bool watchdog) {
+  taskHandles[id].store(xTaskGetCurrentTaskHandle(), std::memory_order_release);
+  if (watchdog) esp_task_wdt_add(NULL);
+}
+
+void healthFeed() {
+  esp_task_wdt_reset();
+}
+
+uint16_t healthStackFree(StatsTaskId id) {
+  const TaskHandle_t h = taskHandles[id].load(std::memory_order_acquire);
+  if (h == nullptr) return STATS_STACK_UNKNOWN;
+  const UBaseType_t free = uxTaskGetStackHighWaterMark(h); // bytes on ESP-IDF
+  return free >= STATS_STACK_UNKNOWN ? STATS_STACK_UNKNOWN - 1 : (uint16_t)free;
+}
+
+uint8_t healthResetReason() {
+  return (uint8_t)esp_reset_reason();
+}
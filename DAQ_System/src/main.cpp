@@ -2,251 +2,854 @@
 #include <Wire.h>
 #include <Adafruit_Sensor.h>
 #include <Adafruit_BNO055.h>
-#include <math.h>
+#include <stddef.h>
+#include <array>
+#include <atomic>
+#include <utility>
+
+#include "daq_config.h"
+#include "frame_packet.h"
+#include "crc16.h"
+#include "spsc_ring.h"
+#include "packet_pool.h"
+#include "adc_dma.h"
+#include "adc_spi.h"
+#include "sampling_timer.h"
+#include "transport.h"
+#include "frame_codec.h"
+#include "profiler.h"
+#include "bno055.h"
+#include "imu_array.h"
+#include "imu_scale.h"
+#include "seqlock.h"
+#include "profiles.h"
+#include "dsp_kernels.h"
+#include "recorder.h"
+#include "flow_control.h"
+#include "hal.h"
+#include "pipeline.h"
+#include "orientation.h"
+#include "power.h"
+#include "health.h"
+#include "control.h"
 
-// ===================== Config =====================
-constexpr uint32_t SERIAL_BAUD = 921600;
-constexpr uint32_t I2C_HZ      = 400000;
+// ===================== IMU =====================
+// One Adafruit_BNO055 per IMU_DEVICES entry (imu_array.h), for bring-up only.
+static TwoWire& imuWire(uint8_t bus) {
+  return bus == 0 ? Wire : Wire1;
+}
 
-constexpr uint32_t ADC_HZ      = 500;    // ADC sampling rate
-constexpr uint32_t IMU_HZ      = 100;    // accel+gyro sampling rate
-constexpr uint32_t MAG_HZ      = 20;     // magnetometer update rate (cached)
+template <size_t... I>
+static std::array<Adafruit_BNO055, IMU_COUNT> makeBnoArray(std::index_sequence<I...>) {
+  return {{Adafruit_BNO055(55 + (int32_t)I, IMU_DEVICES[I].addr, &imuWire(IMU_DEVICES[I].bus))...}};
+}
 
-static_assert((IMU_HZ % MAG_HZ) == 0, "IMU_HZ must be divisible by MAG_HZ");
+static std::array<Adafruit_BNO055, IMU_COUNT> bno = makeBnoArray(std::make_index_sequence<IMU_COUNT>{});
 
-constexpr uint8_t  ADC_BLOCK   = 5;      // 5 ADC samples per frame (10ms @ 500Hz)
-constexpr size_t   ADC_CH      = 6;
-constexpr size_t   IMU_CH_PER  = 9;      // acc(3), gyro(3), mag(3) per IMU
-constexpr size_t   IMU_COUNT   = 2;
-constexpr size_t   IMU_CH      = IMU_CH_PER * IMU_COUNT;
+// Route the device's bus to it (mux channel, if any). setup() and then the
+// task reading that bus only; the selection per bus is cached so direct-wired devices and
+// consecutive reads on one channel cost no extra transaction.
+#if DAQ_IMU_MUX
+static uint8_t muxSelected[IMU_MAX_BUSES] = {IMU_NO_MUX, IMU_NO_MUX};
 
-constexpr uint16_t SYNC_WORD   = 0xA55A;
-constexpr uint8_t  PKT_VER     = 1;
-constexpr uint8_t  PKT_TYPE_FRAME = 1;
+static bool imuSelect(const ImuDevice& dev) {
+  if (muxSelected[dev.bus] == dev.mux) return true;
+  const bool ok = tca9548aSelect(imuWire(dev.bus), IMU_MUX_ADDR, dev.mux);
+  muxSelected[dev.bus] = ok ? dev.mux : IMU_NO_MUX;
+  return ok;
+}
+#else
+static inline bool imuSelect(const ImuDevice&) { return true; }
+#endif
 
-// ADC pins (ESP32)
-static const int ADC_PINS[ADC_CH] = {36, 39, 34, 35, 32, 33};
+// ===================== Shared IMU Cache =====================
+// ImuSnapshot (daq_config.h): imuTask publishes, packerTask reads per frame.
+static SeqLock<ImuSnapshot> imuCache;
+
+#if DAQ_ORIENTATION
+// imuTask -> txTask (both core 0). Full ring: the packet is not sent.
+static SpscRing<OrientationPacket, ORIENT_RING_LEN> orientRing;
+#endif
+
+// ===================== ADC Ring =====================
+// 128 rows = 256ms of slack at 500Hz (32ms, still 3 frames, at the 4kHz EMG
+// profile) before the sampler starts dropping rows
+constexpr size_t ADC_RING_LEN = 128;
+
+static SpscRing<AdcRow, ADC_RING_LEN> adcRing;
+static volatile uint32_t droppedAdcRows = 0;
+static uint16_t adcRingHwm = 0;
+static TaskHandle_t packerTaskHandle = nullptr;
+
+// ===================== Timer Events =====================
+// Referenced by the timer ISRs in callbacks.cpp.
+TaskHandle_t samplingTaskHandle = nullptr; // adcTask, notified by T1_callback
+QueueHandle_t imuTickQueue = nullptr;      // IMU tick numbers from T2_callback
+
+// ===================== Profile =====================
+// rxTask sets requestedProfile; adcTask applies it (it owns the sample clocks)
+// and publishes activeProfile. Rows carry their profile id, so packerTask
+// switches frame layout exactly at the first row sampled under the new one.
+static std::atomic<uint8_t> requestedProfile{PROFILE_BALANCED};
+static std::atomic<uint8_t> activeProfile{PROFILE_BALANCED};
 
-// Queue depth: 256 frames = 2.56s cushion at 100Hz
-constexpr size_t TX_QUEUE_LEN = 256;
+// ===================== TX Queue =====================
+// A pool slot: one frame of whichever profile built it, plus when it was
+// queued (for the queue-wait stage).
+struct TxSlot {
+  uint8_t  frame[FRAME_MAX_BYTES]; // ProfilePacket<P>
+  uint16_t len;                    // sizeof(ProfilePacket<P>)
+  uint32_t t_us;                   // frame t_us, for the sample-to-wire stage
+  uint32_t enq_us;
+};
 
-using sample_t = int16_t;
+// txQueue carries TxSlot* into txPool (packerTask acquires, txTask releases).
+static PacketPool<TxSlot, TX_POOL_LEN> txPool;
+static QueueHandle_t txQueue = nullptr;
+static volatile uint32_t droppedTxPackets = 0;
+static uint16_t txQueueHwm = 0;
+static uint16_t txPoolMinFree = TX_POOL_LEN;
+static TxSlot txScratch; // absorbs a frame when every pool slot is in flight
+
+// ===================== Gaps =====================
+// Runs of frames packerTask built but did not queue, handed to txTask, which
+// sends them as PKT_TYPE_GAP. If gapRing is full the run is not reported and
+// the host counts those frames as link loss.
+static SpscRing<GapRun, 16> gapRing;
+static GapRun packerGap; // packerTask: run being extended
+
+static void packerGapAdd(uint16_t seq, uint32_t adcIdx, uint8_t profile, GapReason why) {
+  if (packerGap.extend(seq, adcIdx, profile, why)) return;
+  gapRing.push(packerGap);
+  packerGap = GapRun{};
+  packerGap.extend(seq, adcIdx, profile, why);
+}
 
-// ===================== IMU =====================
-Adafruit_BNO055 bno0(55, 0x28, &Wire);
-Adafruit_BNO055 bno1(56, 0x29, &Wire);
+// Called before a frame is queued, so its gap marker is sent ahead of it.
+static void packerGapFlush() {
+  if (packerGap.count && gapRing.push(packerGap)) packerGap = GapRun{};
+}
 
-// ===================== Packet =====================
-#pragma pack(push, 1)
-struct FramePacket {
-  uint16_t sync;             // 0xA55A
-  uint8_t  version;          // 1
-  uint8_t  type;             // 1 = FramePacket
-  uint16_t frame_seq;        // increments per frame (100 Hz)
-  uint32_t t_us;             // micros() at start of this frame
-  uint32_t adc_base_idx;     // index of first ADC sample in this frame (500Hz counter)
+// ===================== Profiling =====================
+// One histogram per StatsStageId; each is written by one task only.
+// ADC/pack/IMU/write stages record CPU cycles (same-core durations); queue wait,
+// sample-to-wire and ADC wake are measured against clock times, so they record micros().
+static ProfHistogram profStage[STATS_STAGES];
+static const bool PROF_STAGE_IN_CYCLES[STATS_STAGES] = {true, true, true, false, true, false, false};
 
-  uint16_t adc[ADC_BLOCK][ADC_CH]; // 5x6 ADC samples
+// Deadline misses of the two clock-paced tasks (health.h).
+static DeadlineMonitor adcDeadline;
+static DeadlineMonitor imuDeadline;
 
-  int16_t  imu[IMU_CH];      // two IMUs: acc/gyro/mag scaled by 100 (cached)
+// Global counters
+static volatile uint32_t adcSampleIndex = 0; // increments at the profile's ADC rate
+static uint32_t frameSeq = 0;
+static WideMicros frameClock; // packerTask: row times -> 64-bit frame t_us
 
-  uint16_t crc16;            // CRC16-CCITT over all bytes except this field
-};
-#pragma pack(pop)
-
-static_assert(sizeof(FramePacket) == 112, "FramePacket size must be 112 bytes");
-
-// ===================== CRC16-CCITT =====================
-// Polynomial 0x1021, init 0xFFFF (common CCITT-FALSE style)
-static inline uint16_t crc16_ccitt(const uint8_t* data, size_t len) {
-  uint16_t crc = 0xFFFF;
-  for (size_t i = 0; i < len; i++) {
-    crc ^= (uint16_t)data[i] << 8;
-    for (int b = 0; b < 8; b++) {
-      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+// ---------------- IMU task @ 100Hz ----------------
+// Only tasks that touch Wire/Wire1/BNO055 devices: imuTask, plus with
+// DAQ_IMU_PARALLEL imuBusTask, which owns Wire1 and reads its devices while
+// imuTask reads those on Wire. imuTask is paced by T2_callback via
+// imuTickQueue, not by the FreeRTOS tick.
+// One 18-byte burst per device (32 with DAQ_ORIENTATION); the I2C driver
+// blocks the reading task on the transfer-done interrupt, so core 0 is free for
+// txTask meanwhile.
+
+// last good reading per device (kept if a burst fails); entry d is written only
+// by the task that owns IMU_DEVICES[d].bus
+static Bno055Raw imuRaw[IMU_COUNT];
+static ImuSnapshot imuSnap;
+#if DAQ_ORIENTATION
+static int16_t imuQuat[IMU_COUNT][4];
+#endif
+
+// Read the devices on bus into imuSnap; returns a mask (bit d) of those read.
+static uint32_t imuReadBus(uint8_t bus) {
+  uint32_t fresh = 0;
+  for (size_t d = 0; d < IMU_COUNT; d++) {
+    const ImuDevice& dev = IMU_DEVICES[d];
+    if (dev.bus != bus || !imuSelect(dev)) continue;
+    TwoWire& wire = imuWire(bus);
+    Bno055Raw r;
+    const uint32_t now = (uint32_t)micros();
+    const uint32_t t = now ? now : 1; // 0 means never captured (imuTimeOffset)
+#if DAQ_ORIENTATION
+    if (!bno055ReadAmgQuat(wire, dev.addr, r, imuQuat[d])) continue;
+#else
+    if (!bno055ReadAmg(wire, dev.addr, r)) continue; // keep last values and times
+#endif
+    fresh |= 1u << d;
+
+    // a new mag sample always differs in at least one axis (sensor noise)
+    if (memcmp(r.mag, imuRaw[d].mag, sizeof(r.mag)) != 0) imuSnap.t_mag_us[d] = t;
+    imuSnap.t_us[d] = t;
+    imuRaw[d] = r;
+
+    sample_t* v = &imuSnap.v[d * IMU_CH_PER];
+    for (size_t k = 0; k < 3; k++) {
+      v[k]     = Bno055AccScale::apply(r.acc[k]);
+      v[3 + k] = Bno055GyrScale::apply(r.gyr[k]);
+      v[6 + k] = Bno055MagScale::apply(r.mag[k]);
     }
   }
-  return crc;
+  return fresh;
 }
 
-// ===================== Shared IMU Cache =====================
-static sample_t imuCache[IMU_CH] = {0};
-static portMUX_TYPE imuMux = portMUX_INITIALIZER_UNLOCKED;
+#if DAQ_IMU_PARALLEL
+static TaskHandle_t imuTaskHandle = nullptr;
+static TaskHandle_t imuBusTaskHandle = nullptr;
 
-// ===================== TX Queue =====================
-static QueueHandle_t txQueue = nullptr;
-static volatile uint32_t droppedTxPackets = 0;
-
-// Global counters
-static volatile uint32_t adcSampleIndex = 0; // increments at 500Hz
-static uint16_t frameSeq = 0;
+// Wire1 worker: one burst per notify from imuTask, answered with its fresh
+// mask. Runs above imuTask on the same core, so its transfer is started the
+// moment imuTask asks and both buses are busy at once.
+void imuBusTask(void* pv) {
+  healthWatch(TASK_IMU_BUS, false); // bounded by imuTask's wait, which is watched
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    xTaskNotify(imuTaskHandle, imuReadBus(1), eSetValueWithOverwrite);
+  }
+}
+#endif
 
-// ---------------- IMU task @ 100Hz ----------------
-// Only task that touches Wire/BNO055 devices.
 void imuTask(void* pv) {
-  const TickType_t period = pdMS_TO_TICKS(1000 / IMU_HZ); // 10ms
-  TickType_t lastWake = xTaskGetTickCount();
-
-  const uint32_t magEvery = IMU_HZ / MAG_HZ; // 5
   uint32_t imuTick = 0;
+#if DAQ_ORIENTATION
+  static OrientationPacket orient;
+  uint16_t orientSeq = 0;
+  uint32_t published = 0; // imuCache writes, i.e. the imu_seq packerTask reads
+#endif
+  healthWatch(TASK_IMU, true);
 
-  sensors_event_t a0, g0, m0;
-  sensors_event_t a1, g1, m1;
+  for (;;) {
+    if (xQueueReceive(imuTickQueue, &imuTick, portMAX_DELAY) != pdTRUE) continue;
+    healthFeed();
+    // if we fell behind, serve the newest tick only (a deadline miss)
+    uint32_t pending = 1;
+    while (xQueueReceive(imuTickQueue, &imuTick, 0) == pdTRUE) pending++;
+    const uint32_t readStart = halCycles();
+
+#if DAQ_IMU_PARALLEL
+    xTaskNotifyGive(imuBusTaskHandle);
+    uint32_t fresh = imuReadBus(0);
+    uint32_t fresh1 = 0;
+    // bounded by the Wire1 timeout; imuSnap is not touched until it answers
+    xTaskNotifyWait(0, 0xFFFFFFFFu, &fresh1, portMAX_DELAY);
+    fresh |= fresh1;
+#else
+    uint32_t fresh = 0;
+    for (uint8_t b = 0; b < IMU_BUSES; b++) fresh |= imuReadBus(b);
+#endif
+    (void)fresh; // orientation: which quaternions this burst read
+
+    profStage[STAGE_IMU_READ].record(halCycles() - readStart);
+
+    // the burst must be done before the next tick
+    const uint32_t imuPeriodUs = 1000000u / PROFILES[activeProfile.load()].imuHz;
+    const bool late = imuDeadline.check(pending, imuTickTimeUs(imuTick), (uint32_t)micros(), imuPeriodUs);
+    imuSnap.flags = late ? FRAME_FLAG_IMU_LATE : 0;
+    imuCache.write(imuSnap);
+
+#if DAQ_ORIENTATION
+    published++;
+    orientationPacketFill(orient, orientSeq++, (uint16_t)published, imuSnap.t_us[0], imuQuat, (uint8_t)fresh);
+    orientRing.push(orient);
+#endif
+  }
+}
 
-  // cached mag values for each IMU
-  static sample_t mx0 = 0, my0 = 0, mz0 = 0;
-  static sample_t mx1 = 0, my1 = 0, mz1 = 0;
+// --------------- ADC task (sampler only) ---------------
+// Each row gets its sample index (stampAdcRow), goes to the control path with
+// DAQ_CONTROL (control.h, with the IMU snapshot of the moment, ahead of any
+// buffering), then into adcRing (pushAdcRow), which wakes packerTask once per
+// complete block. Frame assembly is done by packerTask so every tick here has
+// the same length.
+template <class P>
+static inline void stampAdcRow(AdcRow& row) {
+  row.idx = adcSampleIndex++;
+  row.profile = P::ID;
+}
 
-  for (;;) {
-    vTaskDelayUntil(&lastWake, period);
-    imuTick++;
-
-    bno0.getEvent(&a0, Adafruit_BNO055::VECTOR_ACCELEROMETER);
-    bno0.getEvent(&g0, Adafruit_BNO055::VECTOR_GYROSCOPE);
-    bno1.getEvent(&a1, Adafruit_BNO055::VECTOR_ACCELEROMETER);
-    bno1.getEvent(&g1, Adafruit_BNO055::VECTOR_GYROSCOPE);
-
-    sample_t ax0 = (sample_t)lroundf(a0.acceleration.x * 100.0f);
-    sample_t ay0 = (sample_t)lroundf(a0.acceleration.y * 100.0f);
-    sample_t az0 = (sample_t)lroundf(a0.acceleration.z * 100.0f);
-    sample_t gx0 = (sample_t)lroundf(g0.gyro.x * 100.0f);
-    sample_t gy0 = (sample_t)lroundf(g0.gyro.y * 100.0f);
-    sample_t gz0 = (sample_t)lroundf(g0.gyro.z * 100.0f);
-
-    sample_t ax1 = (sample_t)lroundf(a1.acceleration.x * 100.0f);
-    sample_t ay1 = (sample_t)lroundf(a1.acceleration.y * 100.0f);
-    sample_t az1 = (sample_t)lroundf(a1.acceleration.z * 100.0f);
-    sample_t gx1 = (sample_t)lroundf(g1.gyro.x * 100.0f);
-    sample_t gy1 = (sample_t)lroundf(g1.gyro.y * 100.0f);
-    sample_t gz1 = (sample_t)lroundf(g1.gyro.z * 100.0f);
-
-    if ((imuTick % magEvery) == 0) {
-      bno0.getEvent(&m0, Adafruit_BNO055::VECTOR_MAGNETOMETER);
-      mx0 = (sample_t)lroundf(m0.magnetic.x * 100.0f);
-      my0 = (sample_t)lroundf(m0.magnetic.y * 100.0f);
-      mz0 = (sample_t)lroundf(m0.magnetic.z * 100.0f);
-
-      bno1.getEvent(&m1, Adafruit_BNO055::VECTOR_MAGNETOMETER);
-      mx1 = (sample_t)lroundf(m1.magnetic.x * 100.0f);
-      my1 = (sample_t)lroundf(m1.magnetic.y * 100.0f);
-      mz1 = (sample_t)lroundf(m1.magnetic.z * 100.0f);
-    }
+// blocks follows the rows packerTask will see, so a frame restarted after a
+// skipped index still wakes it the moment it completes.
+template <class P>
+static inline void pushAdcRow(const AdcRow& row, BlockTracker<P>& blocks) {
+  const bool pushed = adcRing.push(row);
+  if (!pushed) {
+    droppedAdcRows++;
+  }
 
-    portENTER_CRITICAL(&imuMux);
-    imuCache[0] = ax0; imuCache[1] = ay0; imuCache[2] = az0;
-    imuCache[3] = gx0; imuCache[4] = gy0; imuCache[5] = gz0;
-    imuCache[6] = mx0; imuCache[7] = my0; imuCache[8] = mz0;
+  const uint16_t fill = (uint16_t)adcRing.size();
+  if (fill > adcRingHwm) adcRingHwm = fill;
 
-    imuCache[9]  = ax1; imuCache[10] = ay1; imuCache[11] = az1;
-    imuCache[12] = gx1; imuCache[13] = gy1; imuCache[14] = gz1;
-    imuCache[15] = mx1; imuCache[16] = my1; imuCache[17] = mz1;
-    portEXIT_CRITICAL(&imuMux);
+  // wake the packer once per complete block (a dropped row is not in it)
+  if (pushed && blocks.add(row.idx)) {
+    xTaskNotifyGive(packerTaskHandle);
   }
 }
 
-// --------------- ADC task @ 500Hz (builds frames @100Hz) ---------------
-// Reads ADC every 2ms; every 5 samples => builds a FramePacket and enqueues it.
-void adcTask(void* pv) {
-  const TickType_t period = pdMS_TO_TICKS(1000 / ADC_HZ); // 2ms
-  TickType_t lastWake = xTaskGetTickCount();
+// Samples that were due but give no row (missed sample clock periods, a lost
+// SPI conversion, DMA frames the driver dropped) keep their indices, so the
+// gap is visible downstream. The packer restarts its frame after the gap and
+// pushAdcRow()'s BlockTracker restarts with it, so the wake-up still lands on
+// the row that completes the frame.
+static inline void skipAdcSamples(uint32_t n) {
+  adcSampleIndex = adcSampleIndex + n;
+}
+
+static inline bool profileStillRequested(ProfileId id) {
+  return requestedProfile.load(std::memory_order_relaxed) == id;
+}
 
-  uint16_t adcBlock[ADC_BLOCK][ADC_CH];
-  uint8_t  blockPos = 0;
+// Restart the sample clocks for P (adcTask context). Sample indices restart at
+// 0 and every row from here on carries P::ID.
+// A power-saving profile also drops the PM locks and uses the sleepable clocks.
+template <class P>
+static void beginProfile() {
+  powerProfile(P::ID);
+#if DAQ_ADC_DMA
+  adcDmaBegin(P::ID); // 12-bit, 12dB attenuation, scans P::ADC_CH pins
+  samplingTimersStart(P::ADC_HZ, P::IMU_HZ, false, powerSaving(P::ID));
+#else
+  samplingTimersStart(P::ADC_HZ, P::IMU_HZ, true, powerSaving(P::ID));
+  ulTaskNotifyTake(pdTRUE, 0); // drop wake-ups of the old clock; adcTimerTicks restarted at 0
+#endif
+  adcSampleIndex = 0;
+  activeProfile.store(P::ID);
+}
 
-  uint32_t frameStartUs = 0;
-  uint32_t frameBaseIdx = 0;
+#if DAQ_ADC_DMA
+// DMA backend: the ADC controller scans the profile's channels on its own
+// clock; this task only sleeps until a DMA frame completes and forwards its rows.
+template <class P>
+static void sampleLoop() {
+  beginProfile<P>();
+  AdcRow rows[P::ADC_BLOCK];
+  BlockTracker<P> blocks;
+
+  while (profileStillRequested(P::ID)) {
+    healthFeed();
+    const uint32_t droppedBefore = adcDmaDroppedResults();
+    AdcDmaReadInfo info;
+    const size_t n = adcDmaRead(rows, P::ADC_BLOCK, 100, info);
+    skipAdcSamples(info.lostRows);
+    const uint32_t tickStart = halCycles();
+    // Running late: frames were already queued behind this one, the driver
+    // dropped frames, or results were lost resyncing to a scan.
+    uint8_t flags = 0;
+    if (info.lagFrames || info.lostRows || adcDmaDroppedResults() != droppedBefore) {
+      adcDeadline.miss((uint32_t)micros());
+      flags = FRAME_FLAG_ADC_LATE;
+    }
+#if DAQ_CONTROL
+    static ImuSnapshot imu;
+    const uint32_t imuSeq = n ? imuCache.read(imu) : 0;
+#endif
+    for (size_t i = 0; i < n; i++) {
+      rows[i].flags = flags;
+      stampAdcRow<P>(rows[i]);
+#if DAQ_CONTROL
+      controlPublish(rows[i], imu, imuSeq);
+#endif
+      pushAdcRow<P>(rows[i], blocks);
+    }
+    if (n) profStage[STAGE_ADC_TICK].record(halCycles() - tickStart);
+  }
+}
+#else
+// analogRead / SPI ADC backend: woken by T1_callback every 1/P::ADC_HZ. Row times are
+// the timer's tick times, so they carry no task wake-up jitter; a row read more
+// than one period after its tick is flagged instead. rxTask also notifies this
+// task after a profile request so the loop sees it promptly.
+template <class P>
+static void sampleLoop() {
+  constexpr uint32_t periodUs = 1000000u / P::ADC_HZ;
+  beginProfile<P>();
+  AdcRow row;
+  BlockTracker<P> blocks;
+  uint32_t tick = 0;
+
+  while (profileStillRequested(P::ID)) {
+    // The notification only wakes this task: rxTask sends one per profile
+    // request too, so the periods due come from the tick count.
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    healthFeed();
+    const uint32_t pending = adcTickCount() - tick;
+    if (pending == 0 || !profileStillRequested(P::ID)) continue;
+    const uint32_t tickStart = halCycles();
+
+    // Missed periods keep their sample index, so the gap is visible downstream.
+    tick += pending;
+    skipAdcSamples(pending - 1);
+    row.t_us = adcTickTimeUs(tick);
+    profStage[STAGE_ADC_WAKE].record((uint32_t)micros() - row.t_us);
+
+#if DAQ_ADC_SPI
+    // all channels are converted together; the profile keeps the first P::ADC_CH
+    if (!adcSpiRead(row.adc)) {
+      skipAdcSamples(1); // a lost conversion is a gap like a missed period
+      continue;
+    }
+#else
+    for (size_t ch = 0; ch < P::ADC_CH; ch++) {
+      row.adc[ch] = (uint16_t)analogRead(ADC_PINS[ch]);
+    }
+#endif
+    row.flags = adcDeadline.check(pending, row.t_us, (uint32_t)micros(), periodUs) ? FRAME_FLAG_ADC_LATE : 0;
+
+    stampAdcRow<P>(row);
+#if DAQ_CONTROL
+    static ImuSnapshot imu;
+    controlPublish(row, imu, imuCache.read(imu));
+#endif
+    pushAdcRow<P>(row, blocks);
+    profStage[STAGE_ADC_TICK].record(halCycles() - tickStart);
+  }
+}
+#endif
 
+void adcTask(void* pv) {
+  healthWatch(TASK_ADC, true);
   for (;;) {
-    vTaskDelayUntil(&lastWake, period);
+    withProfile(requestedProfile.load(), [](auto prof) { sampleLoop<decltype(prof)>(); });
+  }
+}
+
+// --------------- Packer task (builds frames) ---------------
+// Pops P::ADC_BLOCK rows, adds header + IMU snapshot + CRC and enqueues the frame.
+// Runs below adcTask on the same core, so it only uses the idle time between ticks.
+// Frames are built in place in a txPool slot; only the slot pointer is queued.
+// Assembly and sealing are the portable FrameAssembler / frameSeal (pipeline.h).
+static inline bool nextAdcRow(AdcRow& row) {
+  while (!adcRing.pop(row)) ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  return true;
+}
+
+// Pack rows of profile P, starting with row, until a row of another profile
+// arrives; that row is left in row for the caller. A partial frame is dropped.
+template <class P>
+static void packLoop(AdcRow& row, TxSlot*& slot) {
+  using Packet = ProfilePacket<P>;
+  FrameAssembler<P> frame;
+
+  do {
+    if (row.profile != P::ID) return;
 
     // start of a new frame
-    if (blockPos == 0) {
-      frameStartUs = (uint32_t)micros();
-      frameBaseIdx = adcSampleIndex; // index of the first sample in this frame
+    if (frame.starts(row)) {
+      if (slot == nullptr) {
+        slot = txPool.acquire();
+        const uint16_t freeSlots = (uint16_t)txPool.available();
+        if (freeSlots < txPoolMinFree) txPoolMinFree = freeSlots;
+      }
+#if DAQ_TX_POLICY == DAQ_TX_POLICY_DROP_OLDEST
+      // pool exhausted: reuse the oldest queued frame's slot instead. The
+      // header layout is the same for every profile.
+      if (slot == nullptr && xQueueReceive(txQueue, &slot, 0) == pdTRUE) {
+        const FramePacket* old = (const FramePacket*)slot->frame;
+        packerGapAdd(old->frame_seq, old->adc_base_idx, old->profile, GAP_DROP_OLDEST);
+        droppedTxPackets++;
+      }
+#endif
+      if (slot == nullptr) slot = &txScratch;
+    }
+
+    // Once the block is full -> build and queue a packet
+    Packet* p = (Packet*)slot->frame;
+    if (!frame.add(row, *p)) continue;
+    const uint32_t packStart = halCycles();
+
+    // consistent IMU snapshot without a critical section
+    ImuSnapshot snap;
+    const uint16_t imuSeq = (uint16_t)imuCache.read(snap);
+    frameSeal<P>(*p, frameSeq++, frameClock.extend(frame.startUs()), frame.flags(), imuSeq, snap);
+    slot->len = sizeof(Packet);
+    slot->t_us = frame.startUs();
+
+    // The recording gets every frame; the link becomes a reduced-rate preview.
+    if (recorderAppend(slot->frame, slot->len) && (p->frame_seq % RECORD_PREVIEW_DIV) != 0) {
+      packerGapAdd(p->frame_seq, p->adc_base_idx, P::ID, GAP_RECORDED);
+      if (slot == &txScratch) slot = nullptr;
+      continue; // keep the slot for the next frame
+    }
+
+    // pool exhausted: the frame still consumed a sequence number, so the
+    // host sees the gap
+    if (slot == &txScratch) {
+      droppedTxPackets++;
+      packerGapAdd(p->frame_seq, p->adc_base_idx, P::ID, GAP_TX_FULL);
+      slot = nullptr;
+      continue;
     }
 
-    // Read 6 ADC channels
-    for (size_t ch = 0; ch < ADC_CH; ch++) {
-      adcBlock[blockPos][ch] = (uint16_t)analogRead(ADC_PINS[ch]);
+    // enqueue the slot pointer (don’t block; keep the slot for reuse if full)
+    packerGapFlush();
+    slot->enq_us = (uint32_t)micros();
+    if (xQueueSend(txQueue, &slot, 0) == pdTRUE) {
+      slot = nullptr;
+      const uint16_t depth = (uint16_t)uxQueueMessagesWaiting(txQueue);
+      if (depth > txQueueHwm) txQueueHwm = depth;
+    } else {
+      droppedTxPackets++;
+      packerGapAdd(p->frame_seq, p->adc_base_idx, P::ID, GAP_TX_FULL);
     }
+    profStage[STAGE_PACK].record(halCycles() - packStart);
+  } while (nextAdcRow(row));
+}
+
+void packerTask(void* pv) {
+  AdcRow row;
+  TxSlot* slot = nullptr; // held across profile switches (the pool is producer/consumer split)
+  healthWatch(TASK_PACKER, false);
 
-    adcSampleIndex++;
-    blockPos++;
-
-    // If we collected 5 samples -> build and queue a packet
-    if (blockPos >= ADC_BLOCK) {
-      blockPos = 0;
-
-      FramePacket p{};
-      p.sync = SYNC_WORD;
-      p.version = PKT_VER;
-      p.type = PKT_TYPE_FRAME;
-      p.frame_seq = frameSeq++;
-      p.t_us = frameStartUs;
-      p.adc_base_idx = frameBaseIdx;
-
-      // copy ADC block
-      for (uint8_t i = 0; i < ADC_BLOCK; i++) {
-        for (size_t ch = 0; ch < ADC_CH; ch++) {
-          p.adc[i][ch] = adcBlock[i][ch];
+  nextAdcRow(row);
+  for (;;) {
+    withProfile(row.profile, [&](auto prof) { packLoop<decltype(prof)>(row, slot); });
+  }
+}
+
+// ---------------- Stats ----------------
+// Build and send one PKT_TYPE_STATS packet (txTask context, between bursts).
+static void sendStatsPacket() {
+  static uint16_t statsSeq = 0;
+  static StatsPacket sp;
+
+  sp.sync = SYNC_WORD;
+  sp.version = PKT_VER;
+  sp.type = PKT_TYPE_STATS;
+  sp.stats_seq = statsSeq++;
+  sp.t_us = (uint32_t)micros();
+  sp.len = (uint8_t)sizeof(StatsPacket);
+  sp.stage_count = STATS_STAGES;
+
+  const uint32_t cpuMhz = halCpuMhz();
+  for (size_t i = 0; i < STATS_STAGES; i++) {
+    const ProfSummary s = profStage[i].collect();
+    // cycles -> ns, or us -> ns; saturate rather than wrap
+    auto toNs = [&](uint32_t v) -> uint32_t {
+      const uint64_t ns = PROF_STAGE_IN_CYCLES[i] ? ((uint64_t)v * 1000) / cpuMhz : (uint64_t)v * 1000;
+      return ns > 0xFFFFFFFFu ? 0xFFFFFFFFu : (uint32_t)ns;
+    };
+    sp.stage[i].count = s.count;
+    sp.stage[i].min_ns = toNs(s.min);
+    sp.stage[i].mean_ns = toNs(s.mean);
+    sp.stage[i].p99_ns = toNs(s.p99);
+    sp.stage[i].max_ns = toNs(s.max);
+  }
+
+  sp.tx_queue_hwm = txQueueHwm;
+  sp.tx_pool_min_free = txPoolMinFree;
+  sp.adc_ring_hwm = adcRingHwm;
+  sp.profile = activeProfile.load();
+  sp.reset_reason = healthResetReason();
+  sp.dropped_tx_packets = droppedTxPackets;
+  sp.dropped_adc_rows = droppedAdcRows;
+#if DAQ_ADC_DMA
+  sp.adc_dma_dropped = adcDmaDroppedResults();
+#else
+  sp.adc_dma_dropped = 0;
+#endif
+
+  const TransportStats& ls = transport().stats();
+  sp.link_bytes = ls.bytes;
+  sp.link_short_writes = ls.shortWrites;
+  sp.link_max_write_us = ls.maxWriteUs;
+  sp.link_tx_hwm = ls.txHighWater;
+
+  sp.adc_deadline_misses = adcDeadline.misses();
+  sp.adc_last_miss_us = adcDeadline.lastMissUs();
+  sp.imu_deadline_misses = imuDeadline.misses();
+  sp.imu_last_miss_us = imuDeadline.lastMissUs();
+
+  const RecorderStats& rs = recorderStats();
+  sp.record_blocks = rs.blocksWritten;
+  sp.record_write_errors = rs.writeErrors;
+  sp.record_max_write_us = rs.maxWriteUs;
+  sp.record_dropped_frames = rs.droppedFrames;
+  for (size_t t = 0; t < STATS_TASKS; t++) sp.stack_free[t] = healthStackFree((StatsTaskId)t);
+
+  sp.crc16 = crc16_ccitt((const uint8_t*)&sp, sizeof(StatsPacket) - sizeof(sp.crc16));
+  transport().write((const uint8_t*)&sp, sizeof(StatsPacket));
+}
+
+// ---------------- TX task ----------------
+// Only place the output link is written. Coalesces every frame already waiting
+// in txQueue (up to TX_BATCH_MAX_FRAMES / TX_BATCH_MAX_BYTES, optionally
+// lingering TX_BATCH_MAX_US, or POWER_TX_LINGER_US in a power-saving profile,
+// for more) into txBatch and sends the burst with a single transport write. A
+// frame that would overflow the burst starts the next.
+// With DAQ_TX_COMPRESS, frames are re-coded on the way into txBatch.
+// Gap markers go out as their own write, ahead of the burst (flow_control.h).
+// With DAQ_ORIENTATION, orientation packets are written as soon as txTask
+// sees them (it polls every tick instead of sleeping a stats period), so they
+// skip the frame backlog and burst lingering.
+static uint8_t txBatch[TX_BATCH_MAX_BYTES];
+
+constexpr size_t TX_GAP_BURST = 8;
+static GapPacket txGaps[TX_GAP_BURST];
+static size_t txGapCount = 0;
+
+static void flushGaps() {
+  if (txGapCount == 0) return;
+  transport().write((const uint8_t*)txGaps, txGapCount * sizeof(GapPacket));
+  txGapCount = 0;
+}
+
+static void emitGap(const GapRun& run) {
+  gapPacketFill(run, txGaps[txGapCount++]);
+  if (txGapCount == TX_GAP_BURST) flushGaps();
+}
+
+#if DAQ_ORIENTATION
+constexpr TickType_t TX_IDLE_WAIT = 1; // orientation latency bound: one tick
+
+static void flushOrientation() {
+  OrientationPacket burst[ORIENT_BURST];
+  size_t n = 0;
+  while (n < ORIENT_BURST && orientRing.pop(burst[n])) n++;
+  if (n) transport().write((const uint8_t*)burst, n * sizeof(OrientationPacket));
+}
+#else
+constexpr TickType_t TX_IDLE_WAIT = pdMS_TO_TICKS(STATS_PERIOD_MS);
+#endif
+
+#if DAQ_TX_POLICY == DAQ_TX_POLICY_DECIMATE
+static GapRun txGap; // txTask: frames skipped by decimation
+
+static void txGapAdd(const FramePacket* f) {
+  if (txGap.extend(f->frame_seq, f->adc_base_idx, f->profile, GAP_DECIMATED)) return;
+  emitGap(txGap);
+  txGap = GapRun{};
+  txGap.extend(f->frame_seq, f->adc_base_idx, f->profile, GAP_DECIMATED);
+}
+#endif
+
+void txTask(void* pv) {
+  TxSlot* slot = nullptr;
+  TxSlot* carry = nullptr; // dequeued, but did not fit the previous burst
+  uint32_t batchFrameUs[TX_BATCH_MAX_FRAMES];
+  uint32_t lastStatsMs = millis();
+  bool congested = false;
+#if DAQ_TX_COMPRESS || DAQ_TX_POLICY == DAQ_TX_POLICY_DEGRADE
+  static FrameEncoder encoder;
+#endif
+  healthWatch(TASK_TX, true);
+
+  for (;;) {
+    healthFeed();
+    // wake at least once per stats period even if no frames arrive
+    if (carry) {
+      slot = carry;
+      carry = nullptr;
+    } else if (xQueueReceive(txQueue, &slot, TX_IDLE_WAIT) != pdTRUE) {
+      slot = nullptr;
+    }
+#if DAQ_ORIENTATION
+    flushOrientation();
+#endif
+
+    if (slot) {
+      GapRun run;
+      while (gapRing.pop(run)) emitGap(run);
+
+      const uint32_t batchStartUs = (uint32_t)micros();
+      // fewer, longer bursts while the chip may sleep between them
+      const uint32_t lingerUs = powerSaving(activeProfile.load()) ? POWER_TX_LINGER_US : TX_BATCH_MAX_US;
+      size_t n = 0;
+      size_t bytes = 0;
+      for (;;) {
+        // backlog behind this frame
+        const size_t depth = uxQueueMessagesWaiting(txQueue);
+        congested = txCongested(depth, congested);
+
+#if DAQ_TX_POLICY == DAQ_TX_POLICY_DECIMATE
+        const FramePacket* f = (const FramePacket*)slot->frame; // same header in every profile
+        const bool send = !congested || (f->frame_seq % txDecimation(depth)) == 0;
+        if (!send) txGapAdd(f);
+#else
+        const bool send = true;
+#endif
+        if (send) {
+          profStage[STAGE_TX_QUEUE_WAIT].record((uint32_t)micros() - slot->enq_us);
+          batchFrameUs[n] = slot->t_us;
+#if DAQ_TX_POLICY == DAQ_TX_POLICY_DEGRADE
+          const bool degrade = congested; // ADC-only frames until the backlog clears
+#else
+          const bool degrade = false;
+#endif
+#if DAQ_TX_COMPRESS
+          bytes += encoder.encode(slot->frame, &txBatch[bytes], degrade);
+#elif DAQ_TX_POLICY == DAQ_TX_POLICY_DEGRADE
+          if (degrade) {
+            bytes += encoder.encode(slot->frame, &txBatch[bytes], true);
+          } else {
+            memcpy(&txBatch[bytes], slot->frame, slot->len);
+            bytes += slot->len;
+          }
+#else
+          (void)degrade;
+          memcpy(&txBatch[bytes], slot->frame, slot->len);
+          bytes += slot->len;
+#endif
+          n++;
+        }
+        txPool.release(slot);
+        if (n >= TX_BATCH_MAX_FRAMES) break;
+
+        TickType_t wait = 0;
+        const uint32_t elapsed = (uint32_t)micros() - batchStartUs;
+        if (elapsed < lingerUs) {
+          wait = pdMS_TO_TICKS((lingerUs - elapsed + 999) / 1000);
+        }
+#if DAQ_ORIENTATION
+        flushOrientation(); // not held back by the linger
+#endif
+        if (xQueueReceive(txQueue, &slot, wait) != pdTRUE) break;
+        // raw size bounds the compressed size too
+        if (bytes + slot->len > TX_BATCH_MAX_BYTES) {
+          carry = slot;
+          break;
         }
       }
 
-      // copy cached IMU
-      portENTER_CRITICAL(&imuMux);
-      for (size_t i = 0; i < IMU_CH; i++) p.imu[i] = imuCache[i];
-      portEXIT_CRITICAL(&imuMux);
+#if DAQ_TX_POLICY == DAQ_TX_POLICY_DECIMATE
+      if (txGap.count) {
+        emitGap(txGap);
+        txGap = GapRun{};
+      }
+#endif
+      flushGaps();
 
-      // CRC over everything except crc16 field
-      p.crc16 = crc16_ccitt((const uint8_t*)&p, sizeof(FramePacket) - sizeof(p.crc16));
+      if (n > 0) { // 0: every frame was decimated
+        const uint32_t writeStart = halCycles();
+        transport().write(txBatch, bytes);
+        profStage[STAGE_TX_WRITE].record(halCycles() - writeStart);
 
-      // enqueue (don’t block; drop if full)
-      if (xQueueSend(txQueue, &p, 0) != pdTRUE) {
-        droppedTxPackets++;
+        const uint32_t nowUs = (uint32_t)micros();
+        for (size_t i = 0; i < n; i++) {
+          profStage[STAGE_SAMPLE_TO_WIRE].record(nowUs - batchFrameUs[i]);
+        }
       }
     }
+
+    if (millis() - lastStatsMs >= STATS_PERIOD_MS) {
+      lastStatsMs += STATS_PERIOD_MS;
+      sendStatsPacket();
+    }
   }
 }
 
-// ---------------- TX task ----------------
-// Only place Serial.write happens.
-void txTask(void* pv) {
-  FramePacket p;
+// ---------------- RX task ----------------
+// Reads host commands (CommandPacket) from the link. A profile request only
+// sets requestedProfile; adcTask performs the switch between two samples.
+static void handleCommand(const CommandPacket& c) {
+  switch (c.cmd) {
+    case CMD_SET_PROFILE:
+      if (c.arg < PROFILE_COUNT && c.arg != requestedProfile.load()) {
+        requestedProfile.store(c.arg);
+#if !DAQ_ADC_DMA
+        xTaskNotifyGive(samplingTaskHandle); // wake the sampler out of its tick wait
+#endif
+      }
+      break;
+    case CMD_RECORD:
+      recorderRequest(c.arg != 0);
+      break;
+    default:
+      break;
+  }
+}
+
+void rxTask(void* pv) {
+  uint8_t buf[64];
+  uint8_t pkt[sizeof(CommandPacket)];
+  size_t have = 0;
+  healthWatch(TASK_RX, false);
+
   for (;;) {
-    if (xQueueReceive(txQueue, &p, portMAX_DELAY) == pdTRUE) {
-      Serial.write((const uint8_t*)&p, sizeof(FramePacket));
+    const size_t n = transport().read(buf, sizeof(buf), 100);
+    for (size_t i = 0; i < n; i++) {
+      // hold bytes only while they can still be the start of a command
+      pkt[have++] = buf[i];
+      if (have == 1 && pkt[0] != (uint8_t)(SYNC_WORD & 0xFF)) {
+        have = 0;
+      } else if (have == 2 && pkt[1] != (uint8_t)(SYNC_WORD >> 8)) {
+        have = 0;
+        if (buf[i] == (uint8_t)(SYNC_WORD & 0xFF)) pkt[have++] = buf[i];
+      } else if (have == sizeof(CommandPacket)) {
+        have = 0;
+        CommandPacket c;
+        memcpy(&c, pkt, sizeof(c));
+        if (c.version == PKT_VER && c.type == PKT_TYPE_CMD &&
+            c.crc16 == crc16_ccitt(pkt, sizeof(c) - sizeof(c.crc16))) {
+          handleCommand(c);
+        }
+      }
     }
   }
 }
 
 void setup() {
-  Serial.begin(SERIAL_BAUD);
+#if DAQ_DSP_BENCH
+  dspKernelsBenchmark(); // console output, before the link owns the port
+#endif
+  transport().begin();
   delay(100);
-  Serial.setTxBufferSize(8192);
 
-  // ADC settings
+  powerBegin(); // no-op unless DAQ_POWER
+  healthBegin();
+
+  recorderBegin(); // no-op unless DAQ_RECORD selects a medium
+
+  // ADC settings (the DMA backend is configured per profile by adcTask)
+#if DAQ_ADC_SPI
+  adcSpiBegin();
+#elif !DAQ_ADC_DMA
   analogReadResolution(12); // 0..4095
   // If your input range needs it:
   // analogSetAttenuation(ADC_11db);
+#endif
 
   // I2C + IMU
-  Wire.begin(21, 22);
-  Wire.setClock(I2C_HZ);
+  for (uint8_t b = 0; b < IMU_BUSES; b++) {
+    TwoWire& wire = imuWire(b);
+    wire.begin(I2C_SDA_PINS[b], I2C_SCL_PINS[b]);
+    wire.setClock(I2C_HZ);
+    wire.setTimeOut(5); // ms; bounds a burst on a stuck bus so imuTask keeps pace
+  }
   delay(50);
 
-  bool ok0 = bno0.begin();
-  bool ok1 = bno1.begin();
+  bool bnoOk[IMU_COUNT];
+  for (size_t d = 0; d < IMU_COUNT; d++) {
+    bnoOk[d] = imuSelect(IMU_DEVICES[d]) && bno[d].begin();
+  }
   delay(20);
-  if (ok0) bno0.setExtCrystalUse(true);
-  if (ok1) bno1.setExtCrystalUse(true);
+  for (size_t d = 0; d < IMU_COUNT; d++) {
+    if (bnoOk[d] && imuSelect(IMU_DEVICES[d])) bno[d].setExtCrystalUse(true);
+  }
 
-  txQueue = xQueueCreate(TX_QUEUE_LEN, sizeof(FramePacket));
+  txQueue = xQueueCreate(TX_QUEUE_LEN, sizeof(TxSlot*));
+  imuTickQueue = xQueueCreate(4, sizeof(uint32_t));
 
   // Core pinning / priorities:
-  // ADC task (500Hz) gets highest prio to reduce jitter.
-  xTaskCreatePinnedToCore(adcTask, "adcTask", 4096, NULL, 4, NULL, 1);
+  // ADC task gets highest prio to reduce jitter; the packer shares core 1 one
+  // level below it. Create the packer first so its handle is valid before the
+  // sampler's first notify. adcTask starts the sample clocks (boot profile) itself.
+  xTaskCreatePinnedToCore(packerTask, "packerTask", 4096, NULL, 3, &packerTaskHandle, 1);
+  xTaskCreatePinnedToCore(adcTask, "adcTask", 4096, NULL, 4, &samplingTaskHandle, 1);
+#if DAQ_IMU_PARALLEL
+  // above imuTask, so the two buses start within a context switch; created
+  // first so its handle is valid before imuTask's first tick
+  xTaskCreatePinnedToCore(imuBusTask, "imuBusTask", 3072, NULL, 4, &imuBusTaskHandle, 0);
+  xTaskCreatePinnedToCore(imuTask, "imuTask", 4096, NULL, 3, &imuTaskHandle, 0);
+#else
   xTaskCreatePinnedToCore(imuTask, "imuTask", 4096, NULL, 3, NULL, 0);
+#endif
   xTaskCreatePinnedToCore(txTask,  "txTask",  4096, NULL, 2, NULL, 0);
+  xTaskCreatePinnedToCore(rxTask,  "rxTask",  3072, NULL, 1, NULL, 0);
 }
 
-void loop() {}
+// Nothing runs in the Arduino loop task; delete it so core 1 can idle (and,
+// with DAQ_POWER, sleep) instead of spinning through an empty loop().
+void loop() {
+  vTaskDelete(NULL);
+}
@@ -0,0 +1,58 @@
+#include <Arduino.h>
+#include "power.h"
+
+#if DAQ_POWER
+
+#include <esp_pm.h>
+#include <esp_sleep.h>
+#if DAQ_TRANSPORT == DAQ_TRANSPORT_UART
+#include <driver/uart.h>
+#endif
+
+#if !CONFIG_PM_ENABLE
+#warning "DAQ_POWER: CONFIG_PM_ENABLE is off in this sdkconfig; the chip runs at full clock"
+#endif
+
+// Only the UART link keeps working across light sleep (wake on RX).
+constexpr bool POWER_LINK_SLEEPS = DAQ_TRANSPORT == DAQ_TRANSPORT_UART;
+
+static esp_pm_lock_handle_t cpuLock = nullptr;     // ESP_PM_CPU_FREQ_MAX
+static esp_pm_lock_handle_t awakeLock = nullptr;   // ESP_PM_NO_LIGHT_SLEEP
+static bool saving = false;                        // both locks released (adcTask)
+
+void powerBegin() {
+  // take the locks first, so nothing runs slower until a saving profile starts
+  esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "daq_cpu", &cpuLock);
+  esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "daq_awake", &awakeLock);
+  if (cpuLock) esp_pm_lock_acquire(cpuLock);
+  if (awakeLock) esp_pm_lock_acquire(awakeLock);
+
+#if DAQ_TRANSPORT == DAQ_TRANSPORT_UART
+  uart_set_wakeup_threshold(UART_NUM_0, POWER_UART_WAKE_EDGES);
+  esp_sleep_enable_uart_wakeup(UART_NUM_0);
+#endif
+
+  esp_pm_config_t cfg = {};
+  cfg.max_freq_mhz = (int)POWER_MAX_CPU_MHZ;
+  cfg.min_freq_mhz = (int)POWER_MIN_CPU_MHZ;
+#if CONFIG_FREERTOS_USE_TICKLESS_IDLE
+  cfg.light_sleep_enable = POWER_LINK_SLEEPS;
+#endif
+  esp_pm_configure(&cfg);
+}
+
+void powerProfile(ProfileId id) {
+  const bool s = powerSaving(id);
+  if (s == saving) return;
+  saving = s;
+
+  if (s) {
+    if (cpuLock) esp_pm_lock_release(cpuLock);
+    if (awakeLock) esp_pm_lock_release(awakeLock);
+  } else {
+    if (cpuLock) esp_pm_lock_acquire(cpuLock);
+    if (awakeLock) esp_pm_lock_acquire(awakeLock);
+  }
+}
+
+#endif // DAQ_POWER
@@ -0,0 +1,245 @@
+#include <Arduino.h>
+#include <atomic>
+#include "recorder.h"
+
+#if DAQ_RECORD
+
+#if DAQ_RECORD == DAQ_RECORD_SD
+#include <FS.h>
+#include <SD_MMC.h>
+#include <stdio.h>
+#elif DAQ_RECORD == DAQ_RECORD_FLASH
+#include <esp_partition.h>
+#else
+#error "unknown DAQ_RECORD backend"
+#endif
+
+struct RecordBlock {
+  uint8_t  data[RECORD_BLOCK_BYTES] __attribute__((aligned(4)));
+  uint32_t len;
+  bool     last;             // session ends with this block
+};
+
+static RecordBlock blocks[RECORD_BLOCKS];
+
+// Block pointers circulate packer -> fullBlocks -> writer -> freeBlocks -> packer.
+static QueueHandle_t freeBlocks = nullptr;
+static QueueHandle_t fullBlocks = nullptr;
+
+static bool ready = false;                 // medium found, writer running
+static std::atomic<bool> wanted{false};    // requested state (recorderRequest)
+static RecorderStats stats{};
+
+// packerTask state
+static RecordBlock* cur = nullptr;
+static bool active = false;
+
+// ===================== Sinks =====================
+class RecordSink {
+public:
+  virtual ~RecordSink() {}
+  virtual bool begin() = 0;
+  virtual bool open() = 0;  // start a session
+  // data holds a whole RECORD_BLOCK_BYTES block; bytes past len are 0xFF
+  virtual bool write(const uint8_t* data, size_t len) = 0;
+  virtual void close() = 0;
+};
+
+#if DAQ_RECORD == DAQ_RECORD_SD
+// One file per session; whole-block writes keep FATFS on the multi-sector
+// path. The FAT is only updated every RECORD_SD_FLUSH_BLOCKS blocks, so a
+// power cut loses at most that much.
+class SdSink : public RecordSink {
+public:
+  bool begin() override { return SD_MMC.begin("/sdcard", false); }
+
+  bool open() override {
+    char path[16];
+    for (unsigned n = 0; n < 10000; n++) {
+      snprintf(path, sizeof(path), "/daq_%04u.bin", n);
+      if (SD_MMC.exists(path)) continue;
+      file_ = SD_MMC.open(path, FILE_WRITE);
+      sinceFlush_ = 0;
+      return (bool)file_;
+    }
+    return false;
+  }
+
+  bool write(const uint8_t* data, size_t len) override {
+    const bool ok = file_.write(data, len) == len;
+    if (++sinceFlush_ >= RECORD_SD_FLUSH_BLOCKS) {
+      file_.flush();
+      sinceFlush_ = 0;
+    }
+    return ok;
+  }
+
+  void close() override { file_.close(); }
+
+private:
+  File file_;
+  uint32_t sinceFlush_ = 0;
+};
+
+static SdSink sinkImpl;
+
+#elif DAQ_RECORD == DAQ_RECORD_FLASH
+// The partition is a ring of blocks. The block after the write position is
+// erased right after each write, so the next write never waits for an erase,
+// and the erased block marks the seam between the newest and oldest data
+// (a dump read from there on is in time order). Sessions start on a block
+// boundary; a short last block is padded with 0xFF, which the host scan skips.
+//
+// Flash writes and erases pause the cache on both cores; the ADC DMA ring and
+// adcRing cover the per-sector pauses.
+class FlashSink : public RecordSink {
+public:
+  bool begin() override {
+    part_ = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, RECORD_PARTITION);
+    if (part_ == nullptr) return false;
+    numBlocks_ = part_->size / RECORD_BLOCK_BYTES;
+    if (numBlocks_ < 2) return false;
+
+    // resume at the erased block left by the previous session
+    pos_ = 0;
+    for (uint32_t b = 0; b < numBlocks_; b++) {
+      uint32_t w = 0;
+      if (esp_partition_read(part_, b * RECORD_BLOCK_BYTES, &w, sizeof(w)) == ESP_OK && w == 0xFFFFFFFF) {
+        pos_ = b;
+        break;
+      }
+    }
+    return eraseBlock(pos_);
+  }
+
+  bool open() override { return true; }
+
+  bool write(const uint8_t* data, size_t) override {
+    bool ok = esp_partition_write(part_, pos_ * RECORD_BLOCK_BYTES, data, RECORD_BLOCK_BYTES) == ESP_OK;
+    pos_ = (pos_ + 1) % numBlocks_;
+    ok &= eraseBlock(pos_);
+    return ok;
+  }
+
+  void close() override {}
+
+private:
+  bool eraseBlock(uint32_t b) {
+    return esp_partition_erase_range(part_, b * RECORD_BLOCK_BYTES, RECORD_BLOCK_BYTES) == ESP_OK;
+  }
+
+  const esp_partition_t* part_ = nullptr;
+  uint32_t numBlocks_ = 0;
+  uint32_t pos_ = 0;
+};
+
+static FlashSink sinkImpl;
+#endif
+
+// ---------------- Writer task ----------------
+static void recordTask(void* pv) {
+  bool open = false;
+  for (;;) {
+    RecordBlock* b = nullptr;
+    xQueueReceive(fullBlocks, &b, portMAX_DELAY);
+
+    if (b->len > 0) {
+      if (!open) open = sinkImpl.open();
+      if (b->len < RECORD_BLOCK_BYTES) memset(b->data + b->len, 0xFF, RECORD_BLOCK_BYTES - b->len);
+
+      const uint32_t t0 = (uint32_t)micros();
+      if (open && sinkImpl.write(b->data, b->len)) {
+        stats.blocksWritten++;
+      } else {
+        stats.writeErrors++;
+      }
+      const uint32_t dt = (uint32_t)micros() - t0;
+      if (dt > stats.maxWriteUs) stats.maxWriteUs = dt;
+    }
+
+    if (b->last && open) {
+      sinkImpl.close();
+      open = false;
+    }
+    xQueueSend(freeBlocks, &b, portMAX_DELAY);
+  }
+}
+
+// ---------------- Packer side ----------------
+static void handOff(bool last) {
+  cur->last = last;
+  xQueueSend(fullBlocks, &cur, 0); // never full: it holds every block
+  cur = nullptr;
+}
+
+static bool takeBlock() {
+  if (xQueueReceive(freeBlocks, &cur, 0) != pdTRUE) return false;
+  cur->len = 0;
+  return true;
+}
+
+bool recorderBegin() {
+  if (!sinkImpl.begin()) return false;
+
+  freeBlocks = xQueueCreate(RECORD_BLOCKS, sizeof(RecordBlock*));
+  fullBlocks = xQueueCreate(RECORD_BLOCKS, sizeof(RecordBlock*));
+  for (size_t i = 0; i < RECORD_BLOCKS; i++) {
+    RecordBlock* b = &blocks[i];
+    xQueueSend(freeBlocks, &b, 0);
+  }
+
+  // Lowest priority on core 0: slow media writes only delay rxTask.
+  xTaskCreatePinnedToCore(recordTask, "recordTask", 4096, NULL, 1, NULL, 0);
+  ready = true;
+  wanted.store(DAQ_RECORD_AUTOSTART != 0);
+  return true;
+}
+
+void recorderRequest(bool on) {
+  if (ready) wanted.store(on);
+}
+
+bool recorderAppend(const uint8_t* frame, size_t len) {
+  const bool on = wanted.load(std::memory_order_relaxed);
+  if (!active) {
+    if (!on) return false;
+    active = true;
+  } else if (!on) {
+    // close the session; an empty last block only tells the writer to close
+    if (cur == nullptr && !takeBlock()) return false; // writer busy: retry next frame
+    handOff(true);
+    active = false;
+    return false;
+  }
+
+  // not recorded: the caller keeps the frame on the link
+  if (cur == nullptr && !takeBlock()) {
+    stats.droppedFrames++;
+    return false;
+  }
+
+  const size_t room = RECORD_BLOCK_BYTES - cur->len;
+  if (len > room && uxQueueMessagesWaiting(freeBlocks) == 0) {
+    stats.droppedFrames++; // never record half a frame
+    return false;
+  }
+
+  const size_t first = len < room ? len : room;
+  memcpy(cur->data + cur->len, frame, first);
+  cur->len += first;
+  if (cur->len == RECORD_BLOCK_BYTES) {
+    handOff(false);
+    if (first < len) {
+      takeBlock(); // checked above
+      memcpy(cur->data, frame + first, len - first);
+      cur->len = len - first;
+    }
+  }
+  return true;
+}
+
+const RecorderStats& recorderStats() {
+  return stats;
+}
+
+#endif // DAQ_RECORD
@@ -0,0 +1,109 @@
+#include <Arduino.h>
+#include <esp_timer.h>
+#include "callbacks.h"
+#include "sampling_timer.h"
+
+static hw_timer_t* adcTimer = nullptr;
+static hw_timer_t* imuTimer = nullptr;
+
+// alarm periods of the current epoch, in SAMPLING_TIMER_HZ ticks
+static uint64_t adcTicks = samplingTimerTicks(ADC_HZ);
+static uint64_t imuTicks = samplingTimerTicks(IMU_HZ);
+
+// micros() value at which both timers were started from zero
+static uint64_t timerEpochUs = 0;
+
+// sleepable clocks (esp_timer task context, created on first use)
+static esp_timer_handle_t adcWakeTimer = nullptr;
+static esp_timer_handle_t imuWakeTimer = nullptr;
+
+constexpr uint64_t SAMPLING_TICKS_PER_US = SAMPLING_TIMER_HZ / 1000000;
+static_assert(SAMPLING_TIMER_HZ % 1000000 == 0, "esp_timer periods are whole microseconds");
+
+static esp_timer_handle_t wakeTimerCreate(void (*cb)(void*), const char* name) {
+  esp_timer_create_args_t args = {};
+  args.callback = cb;
+  args.dispatch_method = ESP_TIMER_TASK;
+  args.name = name;
+  args.skip_unhandled_events = false; // a late wake still delivers every tick
+  esp_timer_handle_t h = nullptr;
+  esp_timer_create(&args, &h);
+  return h;
+}
+
+static void hwTimerEnd(hw_timer_t*& t) {
+  if (t) timerEnd(t);
+  t = nullptr;
+}
+
+// Both clocks from esp_timer; the alarm periods stay in SAMPLING_TIMER_HZ
+// ticks, rounded to whole microseconds, so the *TickTimeUs() math is shared.
+static void wakeTimersStart(bool startAdc) {
+  hwTimerEnd(adcTimer);
+  hwTimerEnd(imuTimer);
+  if (!adcWakeTimer) adcWakeTimer = wakeTimerCreate(&T1_task_callback, "daq_adc");
+  if (!imuWakeTimer) imuWakeTimer = wakeTimerCreate(&T2_task_callback, "daq_imu");
+
+  const uint64_t adcUs = (adcTicks + SAMPLING_TICKS_PER_US / 2) / SAMPLING_TICKS_PER_US;
+  const uint64_t imuUs = (imuTicks + SAMPLING_TICKS_PER_US / 2) / SAMPLING_TICKS_PER_US;
+  adcTicks = adcUs * SAMPLING_TICKS_PER_US;
+  imuTicks = imuUs * SAMPLING_TICKS_PER_US;
+
+  // each start reads the clock again; the two epochs differ by a few us
+  timerEpochUs = (uint64_t)esp_timer_get_time();
+  if (startAdc) esp_timer_start_periodic(adcWakeTimer, adcUs);
+  esp_timer_start_periodic(imuWakeTimer, imuUs);
+}
+
+void samplingTimersStart(uint32_t adcHz, uint32_t imuHz, bool startAdc, bool sleepable) {
+  if (adcTimer) timerStop(adcTimer);
+  if (imuTimer) timerStop(imuTimer);
+  if (adcWakeTimer) esp_timer_stop(adcWakeTimer);
+  if (imuWakeTimer) esp_timer_stop(imuWakeTimer);
+  adcTimerTicks = 0;
+  imuTimerTicks = 0; // both clocks are stopped: tick numbers count from the new epoch
+
+  adcTicks = samplingTimerTicks(adcHz);
+  imuTicks = samplingTimerTicks(imuHz);
+  if (sleepable) {
+    wakeTimersStart(startAdc);
+    return;
+  }
+
+  if (startAdc) {
+    if (!adcTimer) {
+      adcTimer = timerBegin(SAMPLING_TIMER_HZ);
+      timerStop(adcTimer);
+      timerAttachInterrupt(adcTimer, &T1_callback);
+    }
+    timerAlarm(adcTimer, adcTicks, true, 0);
+  }
+
+  if (!imuTimer) {
+    imuTimer = timerBegin(SAMPLING_TIMER_HZ);
+    timerStop(imuTimer);
+    timerAttachInterrupt(imuTimer, &T2_callback);
+  }
+  timerAlarm(imuTimer, imuTicks, true, 0);
+
+  // start both back to back so ADC and IMU ticks share one epoch
+  timerEpochUs = (uint64_t)esp_timer_get_time();
+  if (startAdc) {
+    timerWrite(adcTimer, 0);
+    timerStart(adcTimer);
+  }
+  timerWrite(imuTimer, 0);
+  timerStart(imuTimer);
+}
+
+uint32_t adcTickTimeUs(uint32_t tick) {
+  return (uint32_t)(timerEpochUs + ((uint64_t)tick * adcTicks * 1000000ULL) / SAMPLING_TIMER_HZ);
+}
+
+uint32_t imuTickTimeUs(uint32_t tick) {
+  return (uint32_t)(timerEpochUs + ((uint64_t)tick * imuTicks * 1000000ULL) / SAMPLING_TIMER_HZ);
+}
+
+uint32_t adcTickCount() {
+  return adcTimerTicks;
+}
@@ -0,0 +1,121 @@
+#include <Arduino.h>
+#include <driver/uart.h>
+#include "transport.h"
+
+// Track how long a write blocked, and count bursts the driver cut short.
+static inline void noteWrite(TransportStats& st, size_t len, size_t sent, uint32_t t0) {
+  const uint32_t dt = (uint32_t)micros() - t0;
+  st.bytes += sent;
+  st.writes++;
+  if (sent < len) st.shortWrites++;
+  if (dt > st.maxWriteUs) st.maxWriteUs = dt;
+}
+
+// ===================== UART (ESP-IDF driver) =====================
+// Installs the IDF UART driver directly with a large TX ring; the driver's ISR
+// refills the hardware FIFO from the ring, so write() returns as soon as the
+// burst is copied in. Serial (HardwareSerial) must not be begun on this port.
+class UartTransport : public Transport {
+public:
+  explicit UartTransport(uart_port_t port) : port_(port) {}
+
+  bool begin() override {
+    uart_config_t cfg = {};
+    cfg.baud_rate = (int)SERIAL_BAUD;
+    cfg.data_bits = UART_DATA_8_BITS;
+    cfg.parity = UART_PARITY_DISABLE;
+    cfg.stop_bits = UART_STOP_BITS_1;
+    cfg.flow_ctrl = UART_HW_FLOWCTRL_DISABLE;
+    cfg.source_clk = UART_SCLK_DEFAULT;
+
+    if (uart_driver_install(port_, 256, UART_TX_RING_BYTES, 0, nullptr, 0) != ESP_OK) return false;
+    if (uart_param_config(port_, &cfg) != ESP_OK) return false;
+    return uart_set_pin(port_, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE,
+                        UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE) == ESP_OK;
+  }
+
+  size_t write(const uint8_t* data, size_t len) override {
+    const uint32_t t0 = (uint32_t)micros();
+    const int n = uart_write_bytes(port_, data, len);
+    const size_t sent = n > 0 ? (size_t)n : 0;
+    noteWrite(stats_, len, sent, t0);
+
+    size_t freeBytes = 0;
+    if (uart_get_tx_buffer_free_size(port_, &freeBytes) == ESP_OK) {
+      const uint32_t pending = (uint32_t)(UART_TX_RING_BYTES - freeBytes);
+      if (pending > stats_.txHighWater) stats_.txHighWater = pending;
+    }
+    return sent;
+  }
+
+  size_t read(uint8_t* buf, size_t maxLen, uint32_t timeoutMs) override {
+    if (maxLen == 0) return 0;
+    // block for the first byte only, then take whatever else has arrived
+    const int first = uart_read_bytes(port_, buf, 1, pdMS_TO_TICKS(timeoutMs));
+    if (first <= 0) return 0;
+    size_t buffered = 0;
+    uart_get_buffered_data_len(port_, &buffered);
+    if (buffered > maxLen - 1) buffered = maxLen - 1;
+    const int rest = buffered ? uart_read_bytes(port_, buf + 1, buffered, 0) : 0;
+    return 1 + (rest > 0 ? (size_t)rest : 0);
+  }
+
+  const char* name() const override { return "uart"; }
+
+private:
+  uart_port_t port_;
+};
+
+// ===================== USB CDC =====================
+// With ARDUINO_USB_CDC_ON_BOOT, Serial is the chip's native USB port (TinyUSB
+// CDC or USB-Serial/JTAG), which runs at USB full speed regardless of baud.
+#if DAQ_TRANSPORT == DAQ_TRANSPORT_USB_CDC
+class UsbCdcTransport : public Transport {
+public:
+  bool begin() override {
+    Serial.setTxBufferSize(UART_TX_RING_BYTES);
+    Serial.begin(SERIAL_BAUD);
+    return true;
+  }
+
+  size_t write(const uint8_t* data, size_t len) override {
+    const uint32_t t0 = (uint32_t)micros();
+    const size_t sent = Serial.write(data, len);
+    noteWrite(stats_, len, sent, t0);
+
+    const int room = Serial.availableForWrite();
+    if (room >= 0 && (size_t)room <= UART_TX_RING_BYTES) {
+      const uint32_t pending = (uint32_t)(UART_TX_RING_BYTES - (size_t)room);
+      if (pending > stats_.txHighWater) stats_.txHighWater = pending;
+    }
+    return sent;
+  }
+
+  // Serial has no blocking "any bytes" read, so poll once per tick.
+  size_t read(uint8_t* buf, size_t maxLen, uint32_t timeoutMs) override {
+    const uint32_t t0 = millis();
+    while (Serial.available() <= 0) {
+      if (millis() - t0 >= timeoutMs) return 0;
+      vTaskDelay(1);
+    }
+    size_t n = 0;
+    while (n < maxLen && Serial.available() > 0) buf[n++] = (uint8_t)Serial.read();
+    return n;
+  }
+
+  const char* name() const override { return "usb_cdc"; }
+};
+#endif
+
+Transport& transport() {
+#if DAQ_TRANSPORT == DAQ_TRANSPORT_USB_CDC
+  static UsbCdcTransport t;
+#elif DAQ_TRANSPORT == DAQ_TRANSPORT_UART
+  static UartTransport t(UART_NUM_0);
+#elif DAQ_TRANSPORT == DAQ_TRANSPORT_UDP
+  Transport& t = udpTransport();
+#else
+#error "Unknown DAQ_TRANSPORT"
+#endif
+  return t;
+}
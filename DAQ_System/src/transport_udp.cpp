@@ -0,0 +1,90 @@
+#include <Arduino.h>
+#include "transport.h"
+
+#if DAQ_TRANSPORT == DAQ_TRANSPORT_UDP
+
+#include <WiFi.h>
+#include <lwip/sockets.h>
+
+// txTask never builds a burst larger than one datagram, so a write() is sent
+// as exactly one datagram and never splits a (possibly compressed) frame.
+static_assert(TX_BATCH_MAX_BYTES <= UDP_MAX_PAYLOAD,
+              "TX burst must fit in one UDP datagram");
+
+// ===================== UDP (Wi-Fi STA) =====================
+// Datagrams carry whole, unmodified FramePackets back to back, so the host
+// parses them with the same sync/CRC scan as the serial stream and measures
+// loss from frame_seq. Sent from txTask on core 0, next to the Wi-Fi stack,
+// so core 1 sampling is not disturbed. Host commands come back to the same
+// socket: the host replies to the source address of the data datagrams.
+class UdpTransport : public Transport {
+public:
+  bool begin() override {
+    WiFi.mode(WIFI_STA);
+    WiFi.setSleep(false); // modem sleep adds 100ms+ latency spikes
+    WiFi.begin(DAQ_WIFI_SSID, DAQ_WIFI_PASS);
+
+    sock_ = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock_ < 0) return false;
+
+    int yes = 1;
+    setsockopt(sock_, SOL_SOCKET, SO_BROADCAST, &yes, sizeof(yes));
+
+    memset(&dest_, 0, sizeof(dest_));
+    dest_.sin_family = AF_INET;
+    dest_.sin_port = htons(DAQ_UDP_PORT);
+    dest_.sin_addr.s_addr = inet_addr(DAQ_UDP_HOST);
+    return true;
+  }
+
+  // One burst = one datagram. While Wi-Fi is down (or lwIP is out of buffers)
+  // the burst is dropped and counted as a short write (link_short_writes in
+  // the stats packet); the host sees it as a frame_seq gap.
+  size_t write(const uint8_t* data, size_t len) override {
+    const uint32_t t0 = (uint32_t)micros();
+    size_t sent = 0;
+
+    const bool up = (sock_ >= 0) && WiFi.isConnected();
+    if (up && sendto(sock_, data, len, 0, (const sockaddr*)&dest_, sizeof(dest_)) == (int)len) {
+      sent = len;
+    }
+
+    const uint32_t dt = (uint32_t)micros() - t0;
+    stats_.bytes += sent;
+    stats_.writes++;
+    if (sent < len) stats_.shortWrites++;
+    if (dt > stats_.maxWriteUs) stats_.maxWriteUs = dt;
+    return sent;
+  }
+
+  // One command datagram per read (rxTask).
+  size_t read(uint8_t* buf, size_t maxLen, uint32_t timeoutMs) override {
+    if (sock_ < 0) {
+      vTaskDelay(pdMS_TO_TICKS(timeoutMs));
+      return 0;
+    }
+    fd_set fds;
+    FD_ZERO(&fds);
+    FD_SET(sock_, &fds);
+    timeval tv;
+    tv.tv_sec = timeoutMs / 1000;
+    tv.tv_usec = (timeoutMs % 1000) * 1000;
+    if (select(sock_ + 1, &fds, nullptr, nullptr, &tv) <= 0) return 0;
+
+    const int n = recv(sock_, buf, maxLen, MSG_DONTWAIT);
+    return n > 0 ? (size_t)n : 0;
+  }
+
+  const char* name() const override { return "udp"; }
+
+private:
+  int sock_ = -1;
+  sockaddr_in dest_{};
+};
+
+Transport& udpTransport() {
+  static UdpTransport t;
+  return t;
+}
+
+#endif // DAQ_TRANSPORT == DAQ_TRANSPORT_UDP
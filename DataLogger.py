@@ -5,70 +5,198 @@ A class for real-time serial data acquisition and buffering.
 
 Updated for the DAQ_System binary FRAME protocol:
 
-FramePacket (little-endian, 112 bytes total):
+FramePacket (little-endian, 130 bytes total in the balanced profile):
 
 uint16_t sync        = 0xA55A
-uint8_t  version     = 1
+uint8_t  version     = 9
 uint8_t  type        = 1  (FramePacket)
-uint16_t frame_seq   = increments @ 100 Hz
-uint32_t t_us        = micros() at start of frame
-uint32_t adc_base_idx= index of first ADC sample in this frame (500 Hz counter)
-
-uint16_t adc[5][6]   = 5 samples (2 ms apart) x 6 channels
+uint32_t frame_seq   = increments per frame (100 Hz); does not wrap in practice
+uint64_t t_us        = device time (us since boot) of the frame's first sample
+uint32_t adc_base_idx= index of first ADC sample in this frame (ADC rate counter)
+uint8_t  profile     = acquisition profile id (see PROFILES), fixes the adc[] shape
+uint8_t  flags       = bit 0: a row missed its sampling deadline (read late, or
+                       after skipped periods); bit 1: the IMU burst did
+
+uint16_t adc[B][C]   = B samples x C channels; balanced: 5 x 6 (2 ms apart)
 int16_t  imu[18]     = two BNO055 IMUs; acc/gyro/mag for each, scaled x100
+                       (IMU_COUNT x 9 for other DAQ_IMU_COUNT builds)
+uint16_t imu_seq     = IMU publication count; equal to the previous frame's
+                       when imu[] is a repeat of the same sensor reading
+int16_t  imu_dt[2][2]= per IMU: acc/gyro and mag capture time - t_us, in 10 us
+                       units (-32768 = unknown or older than ~327 ms)
 
 uint16_t crc16       = CRC16-CCITT (poly 0x1021, init 0xFFFF) over all bytes except crc16
 
+Transport:
+- port is a serial device name, or "udp:<port>" to receive the firmware's Wi-Fi
+  UDP stream (several whole FramePackets per datagram, same byte format).
+- Lost frames are counted from frame_seq gaps on either link.
+- type 2 (PKT_TYPE_FRAME_COMPRESSED) frames are variable length: bit-packed
+  delta ADC samples plus only the IMU fields that changed (see frame_codec.h).
+  They expand into exactly the same rows as type 1 frames.
+- type 3 (PKT_TYPE_STATS) packets arrive once a second with per-stage latency
+  (min/mean/p99/max in ns), queue high-water marks and drop counters. They carry
+  no rows; the latest one is available from get_device_stats().
+- set_profile() sends a type 4 (PKT_TYPE_CMD) command back over the same link
+  to switch the acquisition profile at runtime.
+- Frames flagged by the device as sampled off schedule are counted in
+  adc_late_frames / imu_late_frames. The stats packet has the device-side
+  deadline miss counts, least free stack per task and the reset reason (a
+  task watchdog reboot shows as reset_reason "task_wdt"), so device overload
+  can be told apart from link loss.
+- type 5 (PKT_TYPE_GAP) packets name runs of frames the device built but chose
+  not to send (TX backpressure policy, recording preview). lost_frames counts
+  every frame_seq gap; link_lost_frames is what the link lost on top of those.
+- type 6 (PKT_TYPE_ORIENTATION) packets (firmware built with DAQ_ORIENTATION)
+  carry the BNO055 fused quaternion of each IMU and the joint angle between
+  them, once per IMU sample; they are kept in orientation (get_orientation()).
+- Compressed frames flagged as degraded (sent while the link is congested)
+  carry ADC only; their rows have NaN IMU values.
+- native_decoder=True decodes with the C++ daq_decoder extension
+  (host_decoder/, pip install ./host_decoder) when it is installed; rows,
+  loss/gap/IMU counters and device stats are the same, but imu_timestamps and
+  the latency figures are only tracked by the Python decoder.
+
 Behavior:
-- Each received frame expands into 5 "rows" pushed to the queue.
-- Each row is: (adc_sample_index, [adc1..adc6, imu0_9axis, imu1_9axis]).
+- Each received frame is decoded into a block of rows, one per ADC sample,
+  written in one step into a preallocated ring (RowRing, buffer_length rows x
+  channels) by the reader thread. get_channel_data()/channel_view() return numpy
+  views of it, so plotting costs the points plotted, not the rows received;
+  drain_rows() still hands out the rows since its previous call.
+- Each row is: (adc_sample_index, [adc1..adc6, imu0_9axis, imu1_9axis]); ADC
+  channels the active profile does not sample are NaN.
+- adc_sample_index restarts at 0 when the profile changes; profile_id and
+  adc_rate_hz describe the frames currently arriving.
+- start_saving(path) writes every row from then on to a columnar .daqc file
+  (ColumnarWriter), from the reader thread, one chunk at a time; open_saved()
+  maps it back with np.memmap (ColumnarRecording), so a session needs no
+  export step at the end. save_data() still writes CSV from the live buffers.
+- IMU capture times per frame (device us, like t_us) are kept in imu_timestamps
+  so fusion can interpolate instead of treating the IMU values as taken at t_us.
+- frame_seq and t_us are wide enough not to wrap, so a frame is lost, late or
+  a duplicate by one comparison with the last frame_seq, at any frame rate.
 - ADC values are raw 12-bit counts. IMU values are converted to physical units by dividing by 100.
 """
 
 import serial
+import socket
 import threading
-import queue
 from collections import deque
+import json
 import os
 import numpy as np
 import struct
 import time
 
+try:
+    import daq_decoder
+except ImportError:
+    daq_decoder = None
+
 
 class DataLogger:
     SYNC_WORD = 0xA55A
     SYNC_BYTES = struct.pack("<H", SYNC_WORD)
-    PKT_VER = 1
+    PKT_VER = 9
     PKT_TYPE_FRAME = 1
+    PKT_TYPE_FRAME_COMPRESSED = 2
+    PKT_TYPE_STATS = 3
+    PKT_TYPE_CMD = 4
+    PKT_TYPE_GAP = 5
+    PKT_TYPE_ORIENTATION = 6
+    CMD_SET_PROFILE = 1
+    CMD_RECORD = 2
+    COMMAND_STRUCT = struct.Struct("<HBBBB")
+    # A DAQ_POWER device in light sleep wakes on UART RX edges and loses the
+    # bytes that wake it (DAQ_System/include/power.h): serial commands are led
+    # by a few throwaway bytes and a pause. rxTask skips them while it hunts
+    # for the sync word.
+    SERIAL_WAKE_PREAMBLE = b"\x55" * 4
+    SERIAL_WAKE_DELAY_S = 0.002
+
+    # Firmware build config (DAQ_System/include/daq_config.h): ADC_CH is 8 with
+    # DAQ_ADC_SPI, IMU_COUNT is DAQ_IMU_COUNT. Every packet layout below is
+    # derived from these two, as the firmware's are.
+    ADC_CH = 6
+    IMU_COUNT = 2
+
+    # Acquisition profiles (DAQ_System/include/profiles.h); key = profile id
+    PROFILES = {
+        0: {"name": "balanced", "adc_hz": 500.0, "adc_ch": ADC_CH, "adc_block": 5, "imu_hz": 100.0},
+        1: {"name": "emg", "adc_hz": 4000.0, "adc_ch": 2, "adc_block": 40, "imu_hz": 100.0},
+        2: {"name": "low_power", "adc_hz": 100.0, "adc_ch": ADC_CH, "adc_block": 5, "imu_hz": 20.0},
+    }
+    DEFAULT_PROFILE = 0
 
     ADC_RATE_HZ = 500.0
     FRAME_RATE_HZ = 100.0
     ADC_BLOCK = 5
-    ADC_CH = 6
-    IMU_COUNT = 2
     IMU_CH_PER_SENSOR = 9
     IMU_CH = IMU_COUNT * IMU_CH_PER_SENSOR
     IMU_SCALE = 100.0
     TOTAL_CHANNELS = ADC_CH + IMU_CH
 
-    ADC_CHANNEL_NAMES = (
-        "adc0_gpio36",
-        "adc1_gpio39",
-        "adc2_gpio34",
-        "adc3_gpio35",
-        "adc4_gpio32",
-        "adc5_gpio33",
-    )
+    ADC_PINS = (36, 39, 34, 35, 32, 33)
+    if ADC_CH == len(ADC_PINS):
+        ADC_CHANNEL_NAMES = tuple(f"adc{_i}_gpio{_pin}" for _i, _pin in enumerate(ADC_PINS))
+    else:
+        # external SPI ADC (adc_spi.h): inputs V1..V8
+        ADC_CHANNEL_NAMES = tuple(f"adc{_i}_v{_i + 1}" for _i in range(ADC_CH))
     IMU_AXIS_NAMES = ("acc_x", "acc_y", "acc_z", "gyro_x", "gyro_y", "gyro_z", "mag_x", "mag_y", "mag_z")
     CHANNEL_NAMES = list(ADC_CHANNEL_NAMES)
     for _imu_idx in range(IMU_COUNT):
         for _axis in IMU_AXIS_NAMES:
             CHANNEL_NAMES.append(f"imu{_imu_idx}_{_axis}")
     del _imu_idx, _axis
-    PACKET_STRUCT = struct.Struct("<HBBHII30H18hH")
+    FRAME_HEADER_STRUCT = struct.Struct("<HBBIQIBB")
+    FRAME_HEADER_SIZE = FRAME_HEADER_STRUCT.size
+    FRAME_PROFILE_OFFSET = 20
+    FRAME_FLAGS_OFFSET = 21
+    FRAME_FLAG_ADC_LATE = 1 << 0
+    FRAME_FLAG_IMU_LATE = 1 << 1
+    # balanced-profile layout; other profiles differ only in the adc[] length
+    PACKET_STRUCT = struct.Struct(f"<HBBIQIBB{ADC_BLOCK * ADC_CH}H{IMU_CH}hH{2 * IMU_COUNT}hH")
     PACKET_SIZE = PACKET_STRUCT.size
-
-    def __init__(self, port, baud_rate, num_channels, buffer_length=20000, samples_per_event=2):
+    # PKT_TYPE_FRAME_COMPRESSED header: FramePacket header (flags included) + len + imu_mask + imu_seq + imu_dt;
+    # imu_mask has a bit per IMU value plus a spare top bit
+    COMPRESSED_IMU_MASK_BYTES = (IMU_CH + 8) // 8
+    COMPRESSED_HEADER_STRUCT = struct.Struct(f"<HBBIQIBBB{COMPRESSED_IMU_MASK_BYTES}sH{2 * IMU_COUNT}h")
+    COMPRESSED_HEADER_SIZE = COMPRESSED_HEADER_STRUCT.size
+    COMPRESSED_LEN_OFFSET = 22
+    # imu_seq + imu_dt[IMU_COUNT][2] offset in compressed frames (raw: see _imu_seq_offset)
+    COMPRESSED_IMU_SEQ_OFFSET = COMPRESSED_LEN_OFFSET + 1 + COMPRESSED_IMU_MASK_BYTES
+    IMU_TIMING_STRUCT = struct.Struct(f"<H{2 * IMU_COUNT}h")
+    IMU_DT_UNIT_US = 10
+    IMU_DT_INVALID = -32768
+    # PKT_TYPE_GAP (see GapPacket in DAQ_System/include/frame_packet.h)
+    GAP_STRUCT = struct.Struct("<HBBBBIHIH")
+    GAP_SIZE = GAP_STRUCT.size
+    GAP_REASONS = {1: "tx_full", 2: "drop_oldest", 3: "decimated", 4: "recorded"}
+    # PKT_TYPE_ORIENTATION (see OrientationPacket in DAQ_System/include/frame_packet.h)
+    ORIENT_STRUCT = struct.Struct(f"<HBBHHI{4 * IMU_COUNT}hhBBH")
+    ORIENT_SIZE = ORIENT_STRUCT.size
+    ORIENT_QUAT_ONE = 1 << 14
+    ORIENT_JOINT_INVALID = -32768
+    # imu_mask top bit: degraded frame, IMU values left out (frame_codec.h)
+    COMPRESSED_IMU_OMITTED = 1 << (8 * COMPRESSED_IMU_MASK_BYTES - 1)
+
+    # PKT_TYPE_STATS (see StatsPacket in DAQ_System/include/frame_packet.h)
+    STATS_STAGE_NAMES = ("adc_tick", "pack", "imu_read", "tx_queue_wait", "tx_write", "sample_to_wire",
+                         "adc_wake")
+    STATS_HEADER_STRUCT = struct.Struct("<HBBHIBB")
+    STATS_STAGE_STRUCT = struct.Struct("<5I")
+    # StatsTaskId order; stack_free has one entry per task
+    STATS_TASK_NAMES = ("adc", "packer", "imu", "imu_bus", "tx", "rx")
+    STATS_STACK_UNKNOWN = 0xFFFF
+    STATS_TAIL_STRUCT = struct.Struct(f"<3HBB7I4I4I{len(STATS_TASK_NAMES)}HH")
+    # esp_reset_reason_t (ESP-IDF esp_system.h)
+    RESET_REASONS = {0: "unknown", 1: "power_on", 2: "external", 3: "software", 4: "panic", 5: "int_wdt",
+                     6: "task_wdt", 7: "wdt", 8: "deep_sleep", 9: "brownout", 10: "sdio"}
+    STATS_SIZE = STATS_HEADER_STRUCT.size + len(STATS_STAGE_NAMES) * STATS_STAGE_STRUCT.size + STATS_TAIL_STRUCT.size
+    STATS_LEN_OFFSET = 10
+
+    def __init__(self, port, baud_rate, num_channels, buffer_length=20000, samples_per_event=2,
+                 native_decoder=False):
         self.port = port
         self.baud_rate = baud_rate
         if num_channels != self.TOTAL_CHANNELS:
@@ -81,23 +209,51 @@ class DataLogger:
         self.buffer_length = buffer_length
         self.samples_per_event = samples_per_event
 
-        self.row_queue = queue.Queue(maxsize=10000)
-
-        self.channels = [
-            deque([0] * buffer_length, maxlen=buffer_length)
-            for _ in range(self.num_channels)
-        ]
-
-        # Now stores ADC sample indices (32-bit-ish, Python int)
-        self.indices = deque([0] * buffer_length, maxlen=buffer_length)
+        # decoded rows: the reader thread writes, plotting reads views,
+        # drain_rows() follows with its own cursor
+        self.ring = RowRing(buffer_length, self.num_channels)
+        self._drain_tail = 0
 
         self.reader_thread = None
         self.reader_stop = threading.Event()
         self.serial_connection = None
         self.invalid_packets = 0
         self.valid_frames = 0
+        # per frame: (adc_base_idx, imu_seq, [(acc_gyro_t_us, mag_t_us) per IMU]),
+        # device micros(); None where the device reported no valid capture time
+        self.imu_timestamps = deque(maxlen=max(1, buffer_length // self.ADC_BLOCK))
+        # per PKT_TYPE_ORIENTATION packet, see _parse_orientation_packet
+        self.orientation = deque(maxlen=max(1, buffer_length // self.ADC_BLOCK))
+        self._reset_link_stats()
+        # last IMU values seen in compressed frames (omitted fields are unchanged);
+        # NaN until a field arrives after a frame_seq discontinuity
+        self._compressed_imu = [np.nan] * self.IMU_CH
+        self._compressed_seq = None
+        self.device_stats = None
+        self.profile_id = self.DEFAULT_PROFILE
+        self._frame_structs = {}
+        self._udp_socket = None
+        self._udp_peer = None
+        # start_saving(): written by the reader thread, swapped by the caller
+        self._saver = None
+        self._saver_lock = threading.Lock()
+
+        self._native = None
+        if native_decoder:
+            if daq_decoder is None:
+                print("Warning: daq_decoder extension not installed, using the Python decoder")
+            elif daq_decoder.PKT_VER != self.PKT_VER:
+                print(f"Warning: daq_decoder built for PKT_VER {daq_decoder.PKT_VER}, using the Python decoder")
+            elif (daq_decoder.ADC_CH, daq_decoder.IMU_CH) != (self.ADC_CH, self.IMU_CH):
+                print(f"Warning: daq_decoder built for {daq_decoder.ADC_CH} ADC / {daq_decoder.IMU_CH} IMU "
+                      f"channels, using the Python decoder")
+            else:
+                self._native = daq_decoder.Decoder()
 
-        if self.PACKET_SIZE != 112:
+        # framePacketBytes() in frame_packet.h (130 with 6 ADC channels and 2 IMUs)
+        expected = (self.FRAME_HEADER_SIZE + 2 * self.ADC_BLOCK * self.ADC_CH + 2 * self.IMU_CH +
+                    2 + 4 * self.IMU_COUNT + 2)
+        if self.PACKET_SIZE != expected:
             raise RuntimeError(f"Unexpected packet size: {self.PACKET_SIZE} bytes")
 
     # ---------- CRC16 (must match ESP32) ----------
@@ -117,14 +273,47 @@ class DataLogger:
                     crc = (crc << 1) & 0xFFFF
         return crc
 
+    def _frame_struct(self, profile_id):
+        st = self._frame_structs.get(profile_id)
+        if st is None:
+            prof = self.PROFILES[profile_id]
+            st = struct.Struct(f"<HBBIQIBB{prof['adc_block'] * prof['adc_ch']}H{self.IMU_CH}hH{2 * self.IMU_COUNT}hH")
+            self._frame_structs[profile_id] = st
+        return st
+
+    def _imu_seq_offset(self, profile_id):
+        prof = self.PROFILES[profile_id]
+        return self.FRAME_HEADER_SIZE + 2 * prof["adc_block"] * prof["adc_ch"] + 2 * self.IMU_CH
+
+    def _expand_rows(self, profile_id, adc_base_idx, adc_rows, imu_raw):
+        """
+        The frame's rows as one block: (index int64[n], values float64[n,
+        TOTAL_CHANNELS]), one row per ADC sample (adc_rows is block x ch).
+        Channels the profile does not sample are NaN; imu_raw None (degraded
+        frame) gives NaN IMU values. Each row keeps the frame's IMU sample.
+        """
+        prof = self.PROFILES[profile_id]
+        n, ch = prof["adc_block"], prof["adc_ch"]
+        values = np.full((n, self.TOTAL_CHANNELS), np.nan)
+        values[:, :ch] = np.asarray(adc_rows).reshape(n, ch)
+        if imu_raw is not None:
+            values[:, self.ADC_CH:] = np.asarray(imu_raw, dtype=np.float64) / self.IMU_SCALE
+        return np.arange(adc_base_idx, adc_base_idx + n, dtype=np.int64), values
+
     def _parse_frame_packet(self, packet_bytes: bytes):
         """
-        Parse one 112-byte FramePacket and expand it into 5 ADC-sample rows.
+        Parse one FramePacket of any profile and expand it into one row per ADC sample.
 
         Returns:
-            list[(index:int, values:list[float])] or None
+            (index, values) block (see _expand_rows) or None
         """
-        if len(packet_bytes) != self.PACKET_SIZE:
+        if len(packet_bytes) < self.FRAME_HEADER_SIZE:
+            return None
+        profile_id = packet_bytes[self.FRAME_PROFILE_OFFSET]
+        if profile_id not in self.PROFILES:
+            return None
+        st = self._frame_struct(profile_id)
+        if len(packet_bytes) != st.size:
             return None
 
         # Quick sync check before unpack
@@ -132,52 +321,476 @@ class DataLogger:
             return None
 
         # Verify CRC16
-        recv_crc = struct.unpack_from("<H", packet_bytes, self.PACKET_SIZE - 2)[0]
+        recv_crc = struct.unpack_from("<H", packet_bytes, st.size - 2)[0]
         calc_crc = self._crc16_ccitt(packet_bytes[:-2])
         if recv_crc != calc_crc:
             return None
 
-        fields = self.PACKET_STRUCT.unpack(packet_bytes)
+        sync, ver, typ, _frame_seq, _t_us, adc_base_idx, _profile, _flags = \
+            self.FRAME_HEADER_STRUCT.unpack_from(packet_bytes, 0)
+        if sync != self.SYNC_WORD or ver != self.PKT_VER or typ != self.PKT_TYPE_FRAME:
+            return None
 
-        sync = fields[0]
-        ver  = fields[1]
-        typ  = fields[2]
+        # adc[block][ch] uint16 and imu[IMU_CH] int16 follow the header
+        prof = self.PROFILES[profile_id]
+        adc_count = prof["adc_block"] * prof["adc_ch"]
+        adc = np.frombuffer(packet_bytes, dtype="<u2", count=adc_count, offset=self.FRAME_HEADER_SIZE)
+        imu_raw = np.frombuffer(packet_bytes, dtype="<i2", count=self.IMU_CH,
+                                offset=self.FRAME_HEADER_SIZE + 2 * adc_count)
+        self.profile_id = profile_id
+        return self._expand_rows(profile_id, adc_base_idx, adc, imu_raw)
 
-        if sync != self.SYNC_WORD or ver != self.PKT_VER or typ != self.PKT_TYPE_FRAME:
+    def _parse_compressed_packet(self, packet_bytes: bytes):
+        """
+        Parse one PKT_TYPE_FRAME_COMPRESSED packet (see DAQ_System/include/frame_codec.h)
+        into the same row block _parse_frame_packet returns.
+
+        ADC: per channel of the profile a 12-bit first sample, a 4-bit width w and
+        (block - 1) w-bit zigzag deltas, LSB-first. IMU: only fields flagged in imu_mask; the others keep
+        the value from the previous compressed frame. A degraded frame has no IMU fields and NaN IMU rows.
+        The encoder cannot see link loss, so after a frame_seq discontinuity (first frame, lost or late
+        frame, degraded frame) an omitted field is NaN until a frame, at the latest the next keyframe,
+        carries it again.
+        """
+        n = len(packet_bytes)
+        if n < self.COMPRESSED_HEADER_SIZE + 2 or packet_bytes[self.COMPRESSED_LEN_OFFSET] != n:
+            return None
+
+        if packet_bytes[0:2] != self.SYNC_BYTES:
+            return None
+
+        recv_crc = struct.unpack_from("<H", packet_bytes, n - 2)[0]
+        if recv_crc != self._crc16_ccitt(packet_bytes[:-2]):
             return None
 
-        # fields layout:
-        # 0:sync, 1:ver, 2:type, 3:frame_seq, 4:t_us, 5:adc_base_idx,
-        # 6..35: adc flat (30 uint16 = 5 rows x 6 channels),
-        # 36..53: imu flat (18 int16 = 2 IMUs x 9 channels),
-        # 54: crc16
-        frame_seq = fields[3]
-        t_us = fields[4]
-        adc_base_idx = fields[5]
-
-        adc_count = self.ADC_BLOCK * self.ADC_CH
-        adc_flat = fields[6:6 + adc_count]
-        imu_raw = fields[6 + adc_count: 6 + adc_count + self.IMU_CH]
-        imu_vals = [raw / self.IMU_SCALE for raw in imu_raw]
-
-        # Expand into 5 rows: each ADC sample keeps the frame's latest cached IMU sample.
-        rows = []
-        for i in range(self.ADC_BLOCK):
-            base = i * self.ADC_CH
-            adc_vals = adc_flat[base:base + self.ADC_CH]
-            values = list(adc_vals) + list(imu_vals)
-
-            if len(values) != self.num_channels:
+        sync, ver, typ, frame_seq, t_us, adc_base_idx, profile_id, _flags, _length, mask_bytes, _imu_seq, *_imu_dt = \
+            self.COMPRESSED_HEADER_STRUCT.unpack_from(packet_bytes, 0)
+        if sync != self.SYNC_WORD or ver != self.PKT_VER or typ != self.PKT_TYPE_FRAME_COMPRESSED:
+            return None
+        if profile_id not in self.PROFILES:
+            return None
+        adc_ch = self.PROFILES[profile_id]["adc_ch"]
+        adc_block = self.PROFILES[profile_id]["adc_block"]
+
+        bits = int.from_bytes(packet_bytes[self.COMPRESSED_HEADER_SIZE:n - 2], "little")
+        pos = 0
+        adc = [[0] * adc_ch for _ in range(adc_block)]
+        for ch in range(adc_ch):
+            value = (bits >> pos) & 0x0FFF
+            width = (bits >> (pos + 12)) & 0x0F
+            pos += 16
+            adc[0][ch] = value
+            wmask = (1 << width) - 1
+            for i in range(1, adc_block):
+                zz = (bits >> pos) & wmask
+                pos += width
+                value += (zz >> 1) ^ -(zz & 1)
+                adc[i][ch] = value
+
+        offset = self.COMPRESSED_HEADER_SIZE + (pos + 7) // 8
+        mask = int.from_bytes(mask_bytes, "little")
+        if mask & self.COMPRESSED_IMU_OMITTED:
+            if offset != n - 2:
                 return None
+            self._compressed_imu = [np.nan] * self.IMU_CH
+            self._compressed_seq = frame_seq
+            self.profile_id = profile_id
+            return self._expand_rows(profile_id, adc_base_idx, adc, None)
+        imu = self._compressed_imu
+        if self._compressed_seq is None or frame_seq != (self._compressed_seq + 1) & 0xFFFFFFFF:
+            imu = [np.nan] * self.IMU_CH
+        else:
+            imu = list(imu)
+        for i in range(self.IMU_CH):
+            if mask & (1 << i):
+                if offset + 2 > n - 2:
+                    return None
+                imu[i] = struct.unpack_from("<h", packet_bytes, offset)[0]
+                offset += 2
+        if offset != n - 2:
+            return None
 
-            sample_index = int(adc_base_idx + i)
-            rows.append((sample_index, [float(v) for v in values]))
+        self._compressed_imu = imu
+        self._compressed_seq = frame_seq
+        self.profile_id = profile_id
+        return self._expand_rows(profile_id, adc_base_idx, adc, imu)
 
-        return rows
+    def _packet_length(self, buf):
+        """
+        Length of the packet starting at buf[0] (which holds a sync word).
+
+        Returns 0 if more bytes are needed to tell, None for an unknown type.
+        """
+        if len(buf) < 4:
+            return 0
+        typ = buf[3]
+        if typ == self.PKT_TYPE_FRAME:
+            if len(buf) <= self.FRAME_PROFILE_OFFSET:
+                return 0
+            profile_id = buf[self.FRAME_PROFILE_OFFSET]
+            return self._frame_struct(profile_id).size if profile_id in self.PROFILES else None
+        if typ == self.PKT_TYPE_FRAME_COMPRESSED:
+            if len(buf) <= self.COMPRESSED_LEN_OFFSET:
+                return 0
+            length = buf[self.COMPRESSED_LEN_OFFSET]
+            return length if length >= self.COMPRESSED_HEADER_SIZE + 2 else None
+        if typ == self.PKT_TYPE_STATS:
+            if len(buf) <= self.STATS_LEN_OFFSET:
+                return 0
+            length = buf[self.STATS_LEN_OFFSET]
+            return length if length == self.STATS_SIZE else None
+        if typ == self.PKT_TYPE_GAP:
+            return self.GAP_SIZE
+        if typ == self.PKT_TYPE_ORIENTATION:
+            return self.ORIENT_SIZE
+        return None
+
+    def _parse_stats_packet(self, packet_bytes: bytes):
+        """
+        Parse one PKT_TYPE_STATS packet into self.device_stats.
 
-    # ---------- Serial reader ----------
+        Returns [] (no rows) on success, None on a bad packet.
+        """
+        if len(packet_bytes) != self.STATS_SIZE:
+            return None
+        sync, ver, typ, stats_seq, t_us, _length, stage_count = self.STATS_HEADER_STRUCT.unpack_from(packet_bytes, 0)
+        if sync != self.SYNC_WORD or ver != self.PKT_VER or typ != self.PKT_TYPE_STATS:
+            return None
+        if stage_count != len(self.STATS_STAGE_NAMES):
+            return None
+        crc_rx = struct.unpack_from("<H", packet_bytes, self.STATS_SIZE - 2)[0]
+        if self._crc16_ccitt(packet_bytes[:-2]) != crc_rx:
+            return None
+
+        stages = {}
+        off = self.STATS_HEADER_STRUCT.size
+        for name in self.STATS_STAGE_NAMES:
+            count, min_ns, mean_ns, p99_ns, max_ns = self.STATS_STAGE_STRUCT.unpack_from(packet_bytes, off)
+            off += self.STATS_STAGE_STRUCT.size
+            stages[name] = {
+                "count": count,
+                "min_us": min_ns / 1000.0,
+                "mean_us": mean_ns / 1000.0,
+                "p99_us": p99_ns / 1000.0,
+                "max_us": max_ns / 1000.0,
+            }
+
+        (tx_queue_hwm, tx_pool_min_free, adc_ring_hwm, profile_id, reset_reason,
+         dropped_tx_packets, dropped_adc_rows, adc_dma_dropped,
+         link_bytes, link_short_writes, link_max_write_us, link_tx_hwm,
+         adc_deadline_misses, adc_last_miss_us, imu_deadline_misses, imu_last_miss_us,
+         record_blocks, record_write_errors, record_max_write_us, record_dropped_frames,
+         *stack_free, _crc) = self.STATS_TAIL_STRUCT.unpack_from(packet_bytes, off)
+
+        self.device_stats = {
+            "stats_seq": stats_seq,
+            "t_us": t_us,
+            "stages": stages,
+            "tx_queue_hwm": tx_queue_hwm,
+            "tx_pool_min_free": tx_pool_min_free,
+            "adc_ring_hwm": adc_ring_hwm,
+            "profile": self.PROFILES.get(profile_id, {}).get("name", profile_id),
+            "dropped_tx_packets": dropped_tx_packets,
+            "dropped_adc_rows": dropped_adc_rows,
+            "adc_dma_dropped": adc_dma_dropped,
+            "link_bytes": link_bytes,
+            "link_short_writes": link_short_writes,
+            "link_max_write_us": link_max_write_us,
+            "link_tx_hwm": link_tx_hwm,
+            "reset_reason": self.RESET_REASONS.get(reset_reason, reset_reason),
+            "adc_deadline_misses": adc_deadline_misses,
+            "adc_last_miss_us": adc_last_miss_us or None,
+            "imu_deadline_misses": imu_deadline_misses,
+            "imu_last_miss_us": imu_last_miss_us or None,
+            # on-device recorder (all 0 without DAQ_RECORD); dropped frames went to the link
+            "record_blocks": record_blocks,
+            "record_write_errors": record_write_errors,
+            "record_max_write_us": record_max_write_us,
+            "record_dropped_frames": record_dropped_frames,
+            # least free stack since boot, bytes; None for a task not running
+            "stack_free": {name: (None if free == self.STATS_STACK_UNKNOWN else free)
+                           for name, free in zip(self.STATS_TASK_NAMES, stack_free)},
+        }
+        return []
+
+    def _parse_gap_packet(self, packet_bytes: bytes):
+        """
+        Parse one PKT_TYPE_GAP packet into the device gap counters and self.gaps.
+
+        Returns [] (no rows) on success, None on a bad packet.
+        """
+        if len(packet_bytes) != self.GAP_SIZE:
+            return None
+        sync, ver, typ, reason, profile_id, first_seq, count, first_adc_idx, crc_rx = \
+            self.GAP_STRUCT.unpack(packet_bytes)
+        if sync != self.SYNC_WORD or ver != self.PKT_VER or typ != self.PKT_TYPE_GAP:
+            return None
+        if self._crc16_ccitt(packet_bytes[:-2]) != crc_rx:
+            return None
+
+        name = self.GAP_REASONS.get(reason, str(reason))
+        block = self.PROFILES.get(profile_id, self.PROFILES[self.DEFAULT_PROFILE])["adc_block"]
+        self.device_gap_frames[name] = self.device_gap_frames.get(name, 0) + count
+        self.gaps.append({
+            "reason": name,
+            "first_seq": first_seq,
+            "count": count,
+            "first_adc_idx": first_adc_idx,
+            "adc_samples": count * block,
+        })
+        return []
+
+    def _parse_orientation_packet(self, packet_bytes: bytes):
+        """
+        Parse one PKT_TYPE_ORIENTATION packet into self.orientation: device
+        t_us and imu_seq (matching FramePacket.imu_seq), per IMU a (w, x, y, z)
+        unit quaternion or None if the device had no fused reading, and the
+        joint angle in degrees (None unless both quaternions are valid).
+
+        Returns [] (no rows) on success, None on a bad packet.
+        """
+        if len(packet_bytes) != self.ORIENT_SIZE:
+            return None
+        sync, ver, typ, orient_seq, imu_seq, t_us, *rest = self.ORIENT_STRUCT.unpack(packet_bytes)
+        quat_raw, (joint_cdeg, valid, _reserved, crc_rx) = rest[:4 * self.IMU_COUNT], rest[4 * self.IMU_COUNT:]
+        if sync != self.SYNC_WORD or ver != self.PKT_VER or typ != self.PKT_TYPE_ORIENTATION:
+            return None
+        if self._crc16_ccitt(packet_bytes[:-2]) != crc_rx:
+            return None
+
+        quat = [
+            tuple(v / self.ORIENT_QUAT_ONE for v in quat_raw[4 * d:4 * d + 4]) if valid & (1 << d) else None
+            for d in range(self.IMU_COUNT)
+        ]
+        self.orientation.append({
+            "seq": orient_seq,
+            "imu_seq": imu_seq,
+            "t_us": t_us,
+            "quat": quat,
+            "joint_angle_deg": None if joint_cdeg == self.ORIENT_JOINT_INVALID else joint_cdeg / 100.0,
+        })
+        return []
+
+    def _parse_packet(self, packet_bytes: bytes):
+        if packet_bytes[3] == self.PKT_TYPE_FRAME_COMPRESSED:
+            return self._parse_compressed_packet(packet_bytes)
+        if packet_bytes[3] == self.PKT_TYPE_STATS:
+            return self._parse_stats_packet(packet_bytes)
+        if packet_bytes[3] == self.PKT_TYPE_GAP:
+            return self._parse_gap_packet(packet_bytes)
+        if packet_bytes[3] == self.PKT_TYPE_ORIENTATION:
+            return self._parse_orientation_packet(packet_bytes)
+        return self._parse_frame_packet(packet_bytes)
+
+    def _extract_packets(self, buf: bytearray):
+        """
+        Yield (packet_bytes, rows) for every complete packet at the front of buf,
+        consuming it in place. rows is a frame's (index, values) block, None
+        for a packet that failed validation (one byte is skipped and the scan
+        resumes), and [] for a packet without rows (stats, gap, orientation).
+        """
+        while True:
+            if len(buf) < 4:
+                break
+
+            sync_idx = buf.find(self.SYNC_BYTES)
+            if sync_idx == -1:
+                # keep last 1 byte in case it's half sync
+                if len(buf) > 1:
+                    del buf[:-1]
+                break
+
+            if sync_idx > 0:
+                del buf[:sync_idx]
+
+            need = self._packet_length(buf)
+            if need is None:
+                del buf[:1]
+                yield None, None
+                continue
+
+            if need == 0 or len(buf) < need:
+                break
+
+            packet = bytes(buf[:need])
+            rows = self._parse_packet(packet)
+            if rows is None:
+                del buf[:1]
+                yield packet, None
+                continue
+
+            del buf[:need]
+            yield packet, rows
+
+    # ---------- Link statistics ----------
+
+    def _reset_link_stats(self):
+        self.lost_frames = 0
+        self.device_gap_frames = {}
+        self.gaps = deque(maxlen=256)
+        self.late_frames = 0
+        self.adc_late_frames = 0
+        self.imu_late_frames = 0
+        self._last_frame_seq = None
+        self._latency_offset_us = None
+        self._latency_sum_us = 0.0
+        self._latency_count = 0
+        self.latency_max_us = 0.0
+        self.imu_repeated_frames = 0
+        self.imu_skipped_samples = 0
+        self._last_imu_seq = None
+        self.imu_timestamps.clear()
+        self.orientation.clear()
+
+    def _track_frame(self, packet_bytes: bytes):
+        """
+        Update loss, deadline-flag and latency counters from a valid frame's
+        frame_seq / t_us / flags.
+
+        frame_seq is 32-bit and does not wrap within a session, so a forward
+        jump is a gap (lost frames) and anything else is a late or duplicated
+        datagram (the modular step also survives a wrap).
+        Latency is relative: arrival time minus device t_us, measured against
+        the fastest frame seen so far (the two clocks have no common epoch).
+        """
+        frame_seq, t_us = struct.unpack_from("<IQ", packet_bytes, 4)
+        flags = packet_bytes[self.FRAME_FLAGS_OFFSET]
+        if flags & self.FRAME_FLAG_ADC_LATE:
+            self.adc_late_frames += 1
+        if flags & self.FRAME_FLAG_IMU_LATE:
+            self.imu_late_frames += 1
+
+        if self._last_frame_seq is not None:
+            step = (frame_seq - self._last_frame_seq) & 0xFFFFFFFF
+            if step == 0 or step >= 0x80000000:
+                self.late_frames += 1
+                return
+            self.lost_frames += step - 1
+        self._last_frame_seq = frame_seq
+
+        self._track_imu(packet_bytes)
+
+        now_us = int(time.monotonic() * 1e6)
+        delta = now_us - t_us
+        if self._latency_offset_us is None or delta < self._latency_offset_us:
+            self._latency_offset_us = delta
+        rel = float(delta - self._latency_offset_us)
+        self._latency_sum_us += rel
+        self._latency_count += 1
+        if rel > self.latency_max_us:
+            self.latency_max_us = rel
+
+    def _imu_timing_of(self, packet_bytes: bytes):
+        """
+        Return (imu_seq, [dt per IMU for acc/gyro then mag]) from a valid frame.
+        """
+        if packet_bytes[3] == self.PKT_TYPE_FRAME_COMPRESSED:
+            offset = self.COMPRESSED_IMU_SEQ_OFFSET
+        else:
+            offset = self._imu_seq_offset(packet_bytes[self.FRAME_PROFILE_OFFSET])
+        imu_seq, *imu_dt = self.IMU_TIMING_STRUCT.unpack_from(packet_bytes, offset)
+        return imu_seq, imu_dt
+
+    def _track_imu(self, packet_bytes: bytes):
+        """
+        Count frames whose IMU values repeat the previous frame's (same imu_seq)
+        and IMU samples the frames never carried (imu_seq jumped by more than 1),
+        and record the frame's IMU capture times in imu_timestamps.
+        """
+        imu_seq, imu_dt = self._imu_timing_of(packet_bytes)
+        t_us, adc_base_idx = struct.unpack_from("<QI", packet_bytes, 8)
+        captures = []
+        for d in range(self.IMU_COUNT):
+            pair = []
+            for dt in imu_dt[2 * d:2 * d + 2]:
+                pair.append(None if dt == self.IMU_DT_INVALID else t_us + dt * self.IMU_DT_UNIT_US)
+            captures.append(tuple(pair))
+        self.imu_timestamps.append((adc_base_idx, imu_seq, captures))
+
+        if self._last_imu_seq is not None:
+            step = (imu_seq - self._last_imu_seq) & 0xFFFF
+            if step == 0:
+                self.imu_repeated_frames += 1
+            elif step < 0x8000:
+                self.imu_skipped_samples += step - 1
+        self._last_imu_seq = imu_seq
+
+    # ---------- Stream readers ----------
+
+    def _consume_buffer(self, buf: bytearray):
+        """
+        Extract every complete packet from buf (in place) and queue its rows.
+        Shared by the serial and UDP readers, since both carry the same byte stream.
+        """
+        if self._native is not None:
+            self._consume_buffer_native(buf)
+            return
+
+        for packet, rows in self._extract_packets(buf):
+            if rows is None:
+                self.invalid_packets += 1
+                continue
+            if packet[3] not in (self.PKT_TYPE_FRAME, self.PKT_TYPE_FRAME_COMPRESSED):
+                continue
+
+            self.valid_frames += 1
+            self._track_frame(packet)
+            self._push_rows(*rows)
+
+    def _consume_buffer_native(self, buf: bytearray):
+        """
+        _consume_buffer on the daq_decoder extension: the whole buffer is decoded
+        in one call (the decoder keeps any incomplete tail itself).
+        """
+        dec = self._native
+        before = (dec.valid_frames, dec.invalid_packets, dec.lost_frames, dec.late_frames,
+                  dec.imu_repeated_frames, dec.imu_skipped_samples, dec.stats_packets,
+                  dec.adc_late_frames, dec.imu_late_frames)
+        index, values = dec.feed(buf)
+        buf.clear()
+
+        self.valid_frames += dec.valid_frames - before[0]
+        self.invalid_packets += dec.invalid_packets - before[1]
+        self.lost_frames += dec.lost_frames - before[2]
+        self.late_frames += dec.late_frames - before[3]
+        self.imu_repeated_frames += dec.imu_repeated_frames - before[4]
+        self.imu_skipped_samples += dec.imu_skipped_samples - before[5]
+        self.adc_late_frames += dec.adc_late_frames - before[7]
+        self.imu_late_frames += dec.imu_late_frames - before[8]
+        if dec.stats_packets != before[6]:
+            self._parse_stats_packet(dec.last_stats_packet)
+        for gap in dec.take_gaps():
+            self._parse_gap_packet(gap)
+        for orient in dec.take_orientation():
+            self._parse_orientation_packet(orient)
+        if len(index):
+            self.profile_id = dec.profile
+            self._push_rows(index, values)
+
+    def _push_rows(self, index, values):
+        """
+        Reader thread: one decoded block into the ring (and the open .daqc file).
+        """
+        self.ring.write(index, values)
+        if self._saver is not None:
+            with self._saver_lock:
+                if self._saver is not None:
+                    self._saver.append(index, values, self.profile_id)
+
+    @staticmethod
+    def _udp_port_number(port):
+        """
+        Return the UDP port for a "udp:<port>" spec, or None for a serial port name.
+        """
+        if isinstance(port, str) and port.lower().startswith("udp:"):
+            return int(port.split(":", 1)[1])
+        return None
 
     def serial_reader(self, timeout=0.05):
+        if self._udp_port_number(self.port) is not None:
+            self.udp_reader(timeout=timeout)
+            return
+
         try:
             self.serial_connection = serial.Serial(
                 self.port,
@@ -198,53 +811,137 @@ class DataLogger:
                     continue
 
                 buf.extend(chunk)
+                self._consume_buffer(buf)
 
-                while True:
-                    if len(buf) < self.PACKET_SIZE:
-                        break
+            except Exception as e:
+                print("Serial reader error:", e)
+                continue
 
-                    sync_idx = buf.find(self.SYNC_BYTES)
-                    if sync_idx == -1:
-                        # keep last 1 byte in case it's half sync
-                        if len(buf) > 1:
-                            del buf[:-1]
-                        break
+        if self.serial_connection:
+            self.serial_connection.close()
+            print("Serial connection closed")
 
-                    if sync_idx > 0:
-                        del buf[:sync_idx]
+    def udp_reader(self, timeout=0.05):
+        """
+        Receive FramePacket datagrams from the firmware's UDP transport.
+        Each datagram holds whole frames back to back; port is "udp:<port>".
+        """
+        udp_port = self._udp_port_number(self.port)
+        try:
+            sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+            sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+            sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 1 << 20)
+            sock.bind(("", udp_port))
+            sock.settimeout(timeout)
+            self._udp_socket = sock
+            print(f"UDP listener opened on port {udp_port}")
+        except Exception as e:
+            print(f"UDP reader failed to bind port {udp_port}: {e}")
+            return
 
-                    if len(buf) < self.PACKET_SIZE:
-                        break
+        buf = bytearray()
 
-                    packet = bytes(buf[:self.PACKET_SIZE])
-                    rows = self._parse_frame_packet(packet)
-                    if rows is None:
-                        self.invalid_packets += 1
-                        del buf[:1]
-                        continue
+        try:
+            while not self.reader_stop.is_set():
+                try:
+                    datagram, peer = sock.recvfrom(65535)
+                except socket.timeout:
+                    continue
+                except Exception as e:
+                    print("UDP reader error:", e)
+                    continue
 
-                    del buf[:self.PACKET_SIZE]
-                    self.valid_frames += 1
-
-                    # push expanded rows
-                    for row in rows:
-                        try:
-                            self.row_queue.put_nowait(row)
-                        except queue.Full:
-                            # drop oldest, then try again
-                            try:
-                                _ = self.row_queue.get_nowait()
-                                self.row_queue.put_nowait(row)
-                            except queue.Empty:
-                                pass
+                # commands go back to wherever the frames come from
+                self._udp_peer = peer
 
-            except Exception as e:
-                print("Serial reader error:", e)
+                # datagrams never split a frame, so leftovers are garbage
+                buf.clear()
+                buf.extend(datagram)
+                self._consume_buffer(buf)
+        finally:
+            self._udp_socket = None
+            sock.close()
+            print("UDP listener closed")
+
+    # ---------- Device commands ----------
+
+    def _profile_id(self, profile):
+        if isinstance(profile, str):
+            for pid, prof in self.PROFILES.items():
+                if prof["name"] == profile:
+                    return pid
+            raise ValueError(f"Unknown profile {profile!r}")
+        if profile not in self.PROFILES:
+            raise ValueError(f"Unknown profile id {profile}")
+        return int(profile)
+
+    def send_command(self, cmd, arg=0):
+        """
+        Send one PKT_TYPE_CMD packet over the open link. Returns False if no link
+        is open yet (UDP: no datagram has been received from the device yet).
+        """
+        body = self.COMMAND_STRUCT.pack(self.SYNC_WORD, self.PKT_VER, self.PKT_TYPE_CMD, cmd, arg)
+        packet = body + struct.pack("<H", self._crc16_ccitt(body))
+        try:
+            if self._udp_socket is not None and self._udp_peer is not None:
+                self._udp_socket.sendto(packet, self._udp_peer)
+                return True
+            if self.serial_connection is not None and self.serial_connection.is_open:
+                self.serial_connection.write(self.SERIAL_WAKE_PREAMBLE)
+                self.serial_connection.flush()
+                time.sleep(self.SERIAL_WAKE_DELAY_S)
+                self.serial_connection.write(packet)
+                return True
+        except Exception as e:
+            print(f"Failed to send command {cmd}: {e}")
+        return False
+
+    def set_profile(self, profile):
+        """
+        Ask the device to switch acquisition profile (id or name from PROFILES).
+        The switch is confirmed by the profile id of the frames that follow.
+        """
+        return self.send_command(self.CMD_SET_PROFILE, self._profile_id(profile))
+
+    def set_recording(self, on):
+        """
+        Start or stop on-device recording (firmware built with DAQ_RECORD). While
+        it records, the live link only carries every 10th frame, which shows up
+        as lost_frames here; the recording has them all (see read_recording).
+        """
+        return self.send_command(self.CMD_RECORD, 1 if on else 0)
+
+    def read_recording(self, path):
+        """
+        Parse a recording made on the device: an SD card session file
+        (daq_NNNN.bin) or a dump of the 'daqrec' flash partition. Both hold the
+        link's packet stream, block padding (0xFF) is skipped by the sync scan.
+
+        A flash dump is a ring: data after the erased gap is older than the data
+        before it. Rows are returned in file order; sort on the frame t_us if
+        the dump wrapped.
+
+        Returns:
+            {'indices': [int], 'data': [[float]], 'invalid_packets': int}
+        """
+        with open(path, "rb") as f:
+            buf = bytearray(f.read())
+
+        indices = []
+        data = []
+        invalid = 0
+        for packet, rows in self._extract_packets(buf):
+            if rows is None:
+                invalid += 1
                 continue
+            if len(rows):
+                indices.extend(rows[0].tolist())
+                data.extend(rows[1].tolist())
+        return {"indices": indices, "data": data, "invalid_packets": invalid}
 
-        if self.serial_connection:
-            self.serial_connection.close()
-            print("Serial connection closed")
+    @property
+    def adc_rate_hz(self):
+        return self.PROFILES[self.profile_id]["adc_hz"]
 
     # ---------- Control methods ----------
 
@@ -270,69 +967,54 @@ class DataLogger:
             self.reader_thread.join(timeout=0.5)
         print("DataLogger stopped")
 
-    # ---------- Queue + buffer handling ----------
+    # ---------- Ring + buffer handling ----------
 
     def drain_rows(self, max_rows=None, update_buffers=True):
         """
-        Drain parsed rows from the serial-reader queue.
-
-        This keeps parsing centralized in DataLogger while letting UI callers
-        capture the exact rows that were added during a save window.
+        Rows decoded since the previous drain_rows()/read_event()/update_buffers()
+        call, oldest first, as (index, [values]). Rows the ring overwrote before
+        they were drained (more than buffer_length behind) are skipped.
+        update_buffers is accepted for compatibility: the plotted buffers are
+        the ring itself.
         """
-        rows = []
-
-        try:
-            while max_rows is None or len(rows) < max_rows:
-                try:
-                    item = self.row_queue.get_nowait()
-                except queue.Empty:
-                    break
-
-                if not isinstance(item, tuple) or len(item) != 2:
-                    continue
-
-                index, row = item
-
-                if len(row) != self.num_channels:
-                    continue
-
-                if update_buffers:
-                    self.indices.append(index)
-                    for c in range(self.num_channels):
-                        self.channels[c].append(row[c])
-
-                rows.append((index, row))
-
-        except Exception as e:
-            print("Error in drain_rows:", e)
-
-        return rows
+        start, index, values = self.ring.read(self._drain_tail, max_rows)
+        self._drain_tail = start + len(index)
+        return list(zip(index.tolist(), values.tolist()))
 
     def read_event(self):
-        rows = []
-        for _ in range(self.samples_per_event):
-            try:
-                rows.append(self.row_queue.get_nowait())
-            except queue.Empty:
-                break
-        return rows
+        return self.drain_rows(max_rows=self.samples_per_event)
 
     def update_buffers(self):
-        return len(self.drain_rows(update_buffers=True))
+        """
+        Mark every decoded row as drained without copying it; returns how many
+        rows that was (the ring at most).
+        """
+        head = self.ring.head
+        count = min(head - self._drain_tail, self.ring.capacity)
+        self._drain_tail = head
+        return count
 
-    def get_channel_data(self, channel_index, max_points=None):
+    def channel_view(self, channel_index):
+        """
+        The newest buffer_length values of one channel, oldest first, as a view
+        into the ring (zeros before the ring has filled). Later writes show
+        through; copy it to keep a snapshot.
+        """
         if channel_index >= self.num_channels:
             raise ValueError(f"Channel index {channel_index} out of range")
+        _index, values = self.ring.window(self.buffer_length)
+        return values[:, channel_index]
 
-        buf_len = len(self.channels[channel_index])
+    def get_channel_data(self, channel_index, max_points=None):
+        y = self.channel_view(channel_index)
+        buf_len = len(y)
         if max_points is None or buf_len <= max_points:
             step = 1
         else:
             step = max(1, buf_len // max_points)
 
-        x = list(range(0, buf_len, step))
-        y = list(self.channels[channel_index])[::step]
-        return x, y
+        x = np.arange(0, buf_len, step)
+        return x, y[::step]
 
     def get_all_channel_data(self, max_points=None):
         return [self.get_channel_data(i, max_points) for i in range(self.num_channels)]
@@ -380,25 +1062,48 @@ class DataLogger:
         return imu_data
 
     def clear_buffers(self):
-        for channel in self.channels:
-            channel.clear()
-            for _ in range(self.buffer_length):
-                channel.append(0)
-
-        self.indices.clear()
-        for _ in range(self.buffer_length):
-            self.indices.append(0)
+        self.ring.clear()
+        self._drain_tail = 0
 
     def get_queue_size(self):
-        return self.row_queue.qsize()
+        """
+        Rows decoded but not drained yet (the ring at most).
+        """
+        return min(self.ring.head - self._drain_tail, self.ring.capacity)
 
     def get_reader_stats(self):
+        mean_latency_us = self._latency_sum_us / self._latency_count if self._latency_count else 0.0
+        device_dropped = sum(self.device_gap_frames.values())
         return {
             "valid_frames": self.valid_frames,
             "invalid_packets": self.invalid_packets,
-            "queued_rows": self.get_queue_size()
+            "queued_rows": self.get_queue_size(),
+            "lost_frames": self.lost_frames,
+            "link_lost_frames": max(0, self.lost_frames - device_dropped),
+            "device_gap_frames": dict(self.device_gap_frames),
+            "late_frames": self.late_frames,
+            "adc_late_frames": self.adc_late_frames,
+            "imu_late_frames": self.imu_late_frames,
+            "latency_mean_ms": mean_latency_us / 1000.0,
+            "latency_max_ms": self.latency_max_us / 1000.0,
+            "imu_repeated_frames": self.imu_repeated_frames,
+            "imu_skipped_samples": self.imu_skipped_samples,
+            "profile": self.PROFILES[self.profile_id]["name"],
         }
 
+    def get_device_stats(self):
+        """
+        Latest PKT_TYPE_STATS contents from the device, or None if none seen yet.
+        """
+        return self.device_stats
+
+    def get_orientation(self):
+        """
+        Latest PKT_TYPE_ORIENTATION record (see _parse_orientation_packet), or
+        None if the device sends none.
+        """
+        return self.orientation[-1] if self.orientation else None
+
     def is_logging(self):
         return (
             self.reader_thread is not None and
@@ -439,34 +1144,16 @@ class DataLogger:
                 total_bytes += len(chunk)
                 buf.extend(chunk)
 
-                while True:
-                    if len(buf) < self.PACKET_SIZE:
-                        break
-
-                    si = buf.find(self.SYNC_BYTES)
-                    if si == -1:
-                        if len(buf) > 1:
-                            del buf[:-1]
-                        break
-
-                    if si > 0:
-                        del buf[:si]
-
-                    if len(buf) < self.PACKET_SIZE:
-                        break
-
-                    pkt = bytes(buf[:self.PACKET_SIZE])
-                    rows = self._parse_frame_packet(pkt)
+                for _packet, rows in self._extract_packets(buf):
                     if rows is None:
                         invalid_packets += 1
-                        del buf[:1]
+                        continue
+                    if not len(rows):
                         continue
 
-                    del buf[:self.PACKET_SIZE]
                     frames += 1
-                    for idx, values in rows:
-                        indices.append(idx)
-                        data.append(values)
+                    indices.extend(rows[0].tolist())
+                    data.extend(rows[1].tolist())
 
                     if frames >= target_packets:
                         break
@@ -489,7 +1176,7 @@ class DataLogger:
         Detect missing ADC sample indices (no wrap handling by default, since indices are 32-bit+).
         """
         if indices is None:
-            indices = list(self.indices)
+            indices = self.ring.window(self.buffer_length)[0].tolist()
 
         if len(indices) < 2:
             return {'missing_count': 0, 'gaps': [], 'is_continuous': True}
@@ -514,6 +1201,43 @@ class DataLogger:
 
     # ---------- Saving ----------
 
+    def start_saving(self, path, **meta):
+        """
+        Save every row decoded from now on to a columnar .daqc file at path
+        (see ColumnarWriter). The reader thread appends the rows as they are
+        parsed, before they go into the RowRing, so stop_saving() has nothing
+        left to export. meta (JSON-serialisable) goes into the file header.
+
+        Returns the ColumnarWriter; its rows attribute counts the rows saved.
+        """
+        scale = [1.0] * self.ADC_CH + [1.0 / self.IMU_SCALE] * self.IMU_CH
+        header = dict(meta, pkt_ver=self.PKT_VER, adc_ch=self.ADC_CH, imu_count=self.IMU_COUNT,
+                      profiles=self.PROFILES)
+        writer = ColumnarWriter(path, self.CHANNEL_NAMES[:self.num_channels], scale, header)
+        with self._saver_lock:
+            previous, self._saver = self._saver, writer
+        if previous is not None:
+            previous.close()
+        return writer
+
+    def stop_saving(self):
+        """
+        Close the file start_saving() opened (its last, partial chunk is
+        written now). Returns the closed ColumnarWriter, or None.
+        """
+        with self._saver_lock:
+            writer, self._saver = self._saver, None
+        if writer is not None:
+            writer.close()
+        return writer
+
+    @staticmethod
+    def open_saved(path):
+        """
+        Open a .daqc file written by start_saving() (ColumnarRecording).
+        """
+        return ColumnarRecording(path)
+
     def save_data(
         self,
         filename_prefix="channel",
@@ -543,14 +1267,14 @@ class DataLogger:
         if channel_data is None:
             channel_arrays = []
             for channel_idx in range(self.num_channels):
-                ch_data = np.array(list(self.channels[channel_idx]))
+                ch_data = np.array(self.channel_view(channel_idx))
                 ch_data = _trim_initial_zeros(ch_data)
                 channel_arrays.append(ch_data)
         else:
             channel_arrays = [np.array(ch) for ch in channel_data]
 
         if indices_data is None:
-            index_array = np.array(list(self.indices))
+            index_array = np.array(self.ring.window(self.buffer_length)[0])
             index_array = _trim_initial_zeros(index_array) if skip_initial_zeros else index_array
         else:
             index_array = np.array(indices_data)
@@ -644,5 +1368,237 @@ class DataLogger:
         return created_files
 
 
+class RowRing:
+    """
+    Preallocated ring of decoded rows, index int64[capacity] and values
+    float64[capacity, channels], for one writer thread and any readers.
+
+    Storage is doubled and every row is written at position p and p +
+    capacity, so the newest count rows (window()) or any undrained run
+    (read()) is one contiguous slice: readers get views, never copies. head
+    counts rows ever written and is advanced only after the block is in
+    place (an int store, atomic under the GIL), so a reader never sees a half
+    written block; a view can still see newer rows replace its oldest ones if
+    the writer laps it.
+    """
+
+    def __init__(self, capacity, channels):
+        self.capacity = capacity
+        self.index = np.zeros(2 * capacity, dtype=np.int64)
+        self.values = np.zeros((2 * capacity, channels), dtype=np.float64)
+        self.head = 0
+
+    def write(self, index, values):
+        total = len(index)
+        if total == 0:
+            return
+        cap = self.capacity
+        n = total
+        if n > cap:                        # only the newest cap rows survive
+            index, values = index[n - cap:], values[n - cap:]
+            n = cap
+        p = (self.head + total - n) % cap
+        for buf, block in ((self.index, index), (self.values, values)):
+            buf[p:p + n] = block
+            low = min(n, cap - p)          # rows at p < cap: mirror above
+            buf[p + cap:p + cap + low] = block[:low]
+            if low < n:                    # rows past cap: mirror below
+                buf[:n - low] = block[low:]
+        self.head += total
+
+    def window(self, count):
+        """
+        Views (index, values) of the newest count rows (count <= capacity),
+        oldest first; rows never written are zero.
+        """
+        end = self.head % self.capacity + self.capacity
+        return self.index[end - count:end], self.values[end - count:end]
+
+    def read(self, tail, max_rows=None):
+        """
+        Rows from tail (a head value) onwards, skipping any the ring has since
+        overwritten: (first row number, index view, values view).
+        """
+        head = self.head
+        start = max(tail, head - self.capacity)
+        n = head - start
+        if max_rows is not None:
+            n = min(n, max_rows)
+        p = start % self.capacity
+        return start, self.index[p:p + n], self.values[p:p + n]
+
+    def clear(self):
+        self.index.fill(0)
+        self.values.fill(0)
+        self.head = 0
+
+
+class ColumnarWriter:
+    """
+    Incremental writer of the columnar recording format (.daqc).
+
+    Rows are buffered into one chunk of CHUNK_ROWS; each full chunk is a single
+    write, so saving costs the reader thread one numpy conversion per frame and
+    a crash loses at most the chunk being filled.
+
+    File layout (little-endian):
+      MAGIC, uint32 header length, JSON header padded with spaces so the
+      first chunk starts at a multiple of ALIGN bytes:
+        channels   channel names, in row order
+        scale      per channel: physical value = stored value * scale
+        chunk_rows rows per chunk
+        missing    stored value of a NaN (channel the profile does not
+                   sample, IMU values of a degraded frame)
+        + the DataLogger layout (pkt_ver, adc_ch, imu_count, profiles) and
+          the caller's metadata
+      chunks of chunk_dtype(): uint32 rows (chunk_rows in every chunk but the
+      last), uint32 reserved, int64 index[chunk_rows] (adc_sample_index),
+      int16 values[channels][chunk_rows], uint8 profile[chunk_rows]
+    Values are rounded to the nearest step and saturate at +-32767 (-32768
+    is missing only), which holds the 12-bit ADC counts and the x100 IMU
+    values exactly.
+    """
+    MAGIC = b"DAQCOL\x00\x01"
+    MISSING = -32768
+    CHUNK_ROWS = 4096
+    ALIGN = 64
+
+    @staticmethod
+    def chunk_dtype(channels, chunk_rows):
+        return np.dtype([
+            ("rows", "<u4"),
+            ("reserved", "<u4"),
+            ("index", "<i8", (chunk_rows,)),
+            ("values", "<i2", (channels, chunk_rows)),
+            ("profile", "u1", (chunk_rows,)),
+        ])
+
+    def __init__(self, path, channel_names, scale, header=None, chunk_rows=CHUNK_ROWS):
+        self.path = path
+        self.rows = 0
+        self._channels = len(channel_names)
+        self._chunk_rows = chunk_rows
+        self._inv_scale = 1.0 / np.asarray(scale, dtype=np.float64)
+        self._chunk = np.zeros((), dtype=self.chunk_dtype(self._channels, chunk_rows))
+        self._fill = 0
+
+        body = json.dumps(dict(header or {}, channels=list(channel_names), scale=list(scale),
+                               chunk_rows=chunk_rows, missing=self.MISSING)).encode()
+        body += b" " * (-(len(self.MAGIC) + 4 + len(body)) % self.ALIGN)
+        self._file = open(path, "wb")
+        self._file.write(self.MAGIC + struct.pack("<I", len(body)) + body)
+
+    def append(self, indices, values, profile):
+        """
+        Append rows: indices[n] and values[n][channels] as DataLogger queues
+        them (floats, NaN where missing), all sampled under profile.
+        """
+        idx = np.asarray(indices, dtype=np.int64)
+        n = len(idx)
+        if n == 0:
+            return
+        codes = np.rint(np.asarray(values, dtype=np.float64).reshape(n, self._channels) * self._inv_scale)
+        missing = np.isnan(codes)
+        codes = np.clip(codes, -32767, 32767)  # -32768 stays reserved for MISSING
+        codes[missing] = self.MISSING
+        codes = codes.astype(np.int16)
+
+        pos = 0
+        while pos < n:
+            k = min(n - pos, self._chunk_rows - self._fill)
+            at = slice(self._fill, self._fill + k)
+            self._chunk["index"][at] = idx[pos:pos + k]
+            self._chunk["values"][:, at] = codes[pos:pos + k].T
+            self._chunk["profile"][at] = profile
+            self._fill += k
+            self.rows += k
+            pos += k
+            if self._fill == self._chunk_rows:
+                self._write_chunk()
+
+    def _write_chunk(self):
+        self._chunk["rows"] = self._fill
+        self._file.write(self._chunk.tobytes())
+        self._file.flush()
+        self._fill = 0
+
+    def close(self):
+        if self._file.closed:
+            return
+        if self._fill:
+            self._write_chunk()
+        self._file.close()
+
+
+class ColumnarRecording:
+    """
+    A .daqc file (ColumnarWriter) opened with np.memmap: only the chunks a
+    query touches are read. Row r is slot r % chunk_rows of chunk
+    r // chunk_rows, since only the last chunk is partial.
+
+    chunks is the raw structured array; index(), channel() and profile() return
+    a row range [start, stop) as plain arrays.
+    """
+
+    def __init__(self, path):
+        magic = ColumnarWriter.MAGIC
+        with open(path, "rb") as f:
+            head = f.read(len(magic) + 4)
+            if len(head) != len(magic) + 4 or head[:len(magic)] != magic:
+                raise ValueError(f"{path} is not a .daqc recording")
+            (length,) = struct.unpack_from("<I", head, len(magic))
+            self.header = json.loads(f.read(length))
+
+        self.channel_names = list(self.header["channels"])
+        self.scale = np.asarray(self.header["scale"], dtype=np.float64)
+        self.chunk_rows = int(self.header["chunk_rows"])
+        self.missing = int(self.header["missing"])
+
+        dtype = ColumnarWriter.chunk_dtype(len(self.channel_names), self.chunk_rows)
+        offset = len(magic) + 4 + length
+        count = (os.path.getsize(path) - offset) // dtype.itemsize  # a torn last chunk is ignored
+        if count > 0:
+            self.chunks = np.memmap(path, dtype=dtype, mode="r", offset=offset, shape=(count,))
+            self.rows = int(self.chunks["rows"].sum())
+        else:
+            self.chunks = np.zeros(0, dtype=dtype)
+            self.rows = 0
+
+    def __len__(self):
+        return self.rows
+
+    def _gather(self, field, start, stop, channel=None):
+        start, stop, _ = slice(start, stop).indices(self.rows)
+        n = self.chunk_rows
+        parts = []
+        for c in range(start // n, (stop + n - 1) // n if stop > start else 0):
+            lo, hi = max(start - c * n, 0), min(stop - c * n, n)
+            column = self.chunks[field][c] if channel is None else self.chunks[field][c, channel]
+            parts.append(np.asarray(column[lo:hi]))
+        if parts:
+            return np.concatenate(parts)
+        return np.zeros(0, dtype=self.chunks.dtype[field].base)
+
+    def index(self, start=0, stop=None):
+        return self._gather("index", start, stop)
+
+    def profile(self, start=0, stop=None):
+        return self._gather("profile", start, stop)
+
+    def channel(self, channel, start=0, stop=None, raw=False):
+        """
+        Rows [start, stop) of one channel (index or name): physical values
+        (float64, NaN where missing), or the stored int16 values with raw=True.
+        """
+        if isinstance(channel, str):
+            channel = self.channel_names.index(channel)
+        values = self._gather("values", start, stop, channel)
+        if raw:
+            return values
+        out = values.astype(np.float64) * self.scale[channel]
+        out[values == self.missing] = np.nan
+        return out
+
+
 if __name__ == "__main__":
     print("This module defines DataLogger class for binary real-time serial data acquisition.")
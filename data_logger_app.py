@@ -3,9 +3,10 @@ data_logger_app.py
 ------------------
 A simple live viewer and start/stop saver for the DAQ DataLogger.
 
-The binary serial parsing stays inside DataLogger. This app only drains parsed
-rows, shows them in a Tkinter window, and asks DataLogger.save_data() to write
-the captured rows when saving stops.
+The binary serial parsing stays inside DataLogger. This app only plots views
+of its decoded-row ring in a Tkinter window. Saving is DataLogger.start_saving():
+the reader thread writes a columnar .daqc file while the session runs (open it
+with DataLogger.open_saved()), so stopping has nothing left to export.
 """
 
 import re
@@ -15,6 +16,8 @@ from pathlib import Path
 import tkinter as tk
 from tkinter import messagebox, ttk
 
+import numpy as np
+
 from matplotlib.backends.backend_tkagg import FigureCanvasTkAgg
 from matplotlib.figure import Figure
 
@@ -26,7 +29,7 @@ except Exception:
     list_ports = None
 
 
-DEFAULT_BAUD = 921600
+DEFAULT_BAUD = 2000000
 BUFFER_LEN = 10000
 UI_INTERVAL_MS = 100
 MAX_ADC_POINTS = 10000
@@ -97,9 +100,7 @@ class DataLoggerApp:
 
         self.logger = None
         self.saving = False
-        self.save_started_at = None
-        self.save_indices = []
-        self.save_rows = []
+        self.save_writer = None
         self.serial_ports = get_available_serial_ports()
 
         self.name_var = tk.StringVar()
@@ -340,9 +341,17 @@ class DataLoggerApp:
             messagebox.showerror("Missing information", "Please enter name, activity, and session ID before saving.")
             return
 
-        self.save_indices = []
-        self.save_rows = []
-        self.save_started_at = datetime.now()
+        save_dir = Path("saved_data") / safe_path_part(name, "unknown_name") / \
+            safe_path_part(activity, "unknown_activity") / safe_path_part(session, "session")
+        started = datetime.now()
+        path = save_dir / f"{safe_path_part(session, 'session')}_{started.strftime('%Y%m%d_%H%M%S')}.daqc"
+        try:
+            save_dir.mkdir(parents=True, exist_ok=True)
+            self.save_writer = self.logger.start_saving(
+                str(path), name=name, activity=activity, session=session, started=started.isoformat())
+        except OSError as e:
+            messagebox.showerror("Save failed", f"Cannot create {path}:\n{e}")
+            return
         self.saving = True
         self.save_button.config(text="Stop Saving", style="Stop.TButton")
         self.status_var.set("Saving started")
@@ -352,42 +361,15 @@ class DataLoggerApp:
         self.saving = False
         self.save_button.config(text="Start Saving", style="Start.TButton")
 
-        if len(self.save_rows) == 0:
+        writer = self.logger.stop_saving() if self.logger is not None else None
+        self.save_writer = None
+        if writer is None or writer.rows == 0:
             self.status_var.set("Saving stopped - no samples captured")
             messagebox.showwarning("No data", "No incoming samples were captured during this save window.")
             return
 
-        name = safe_path_part(self.name_var.get(), "unknown_name")
-        activity = safe_path_part(self.activity_var.get(), "unknown_activity")
-        session = safe_path_part(self.session_var.get(), "session")
-        save_dir = Path("saved_data") / name / activity / session
-        timestamp = self.save_started_at.strftime("%Y%m%d_%H%M%S") if self.save_started_at else datetime.now().strftime("%Y%m%d_%H%M%S")
-        filename_prefix = f"{session}_{timestamp}"
-
-        channel_data = [
-            [row[channel_idx] for row in self.save_rows]
-            for channel_idx in range(DataLogger.TOTAL_CHANNELS)
-        ]
-
-        created_files = self.logger.save_data(
-            filename_prefix=filename_prefix,
-            file_extension=".csv",
-            save_directory=str(save_dir),
-            skip_initial_zeros=False,
-            sample_rate=DataLogger.ADC_RATE_HZ,
-            timestamp_start=0.0,
-            combined=True,
-            include_indices=True,
-            indices_data=self.save_indices,
-            channel_data=channel_data,
-        )
-
-        if created_files:
-            self.status_var.set(f"Saved {len(self.save_rows)} samples to {created_files[0]}")
-            messagebox.showinfo("Saved", f"Saved {len(self.save_rows)} samples to:\n{created_files[0]}")
-        else:
-            self.status_var.set("Save failed")
-            messagebox.showerror("Save failed", "DataLogger.save_data() did not create a file.")
+        self.status_var.set(f"Saved {writer.rows} samples to {writer.path}")
+        messagebox.showinfo("Saved", f"Saved {writer.rows} samples to:\n{writer.path}")
 
     def _refresh_window(self):
         self._drain_logger()
@@ -404,17 +386,14 @@ class DataLoggerApp:
         if self.logger is None:
             return
 
-        rows = self.logger.drain_rows(update_buffers=True)
-        if self.saving and rows:
-            for index, row in rows:
-                self.save_indices.append(index)
-                self.save_rows.append(list(row))
-            self.samples_var.set(f"Saved samples: {len(self.save_rows)}")
+        self.logger.update_buffers()
 
         stats = self.logger.get_reader_stats()
-        if self.saving:
+        if self.saving and self.save_writer is not None:
+            saved = self.save_writer.rows
+            self.samples_var.set(f"Saved samples: {saved}")
             suffix = f" | valid frames: {stats['valid_frames']} | queued rows: {stats['queued_rows']}"
-            self.status_var.set(f"Saving... {len(self.save_rows)} samples{suffix}")
+            self.status_var.set(f"Saving... {saved} samples{suffix}")
 
     def _update_plots(self, force_rescale=False):
         if self.logger is None:
@@ -444,12 +423,12 @@ class DataLoggerApp:
                 axis.set_ylim(0, 4095)
 
     def _decimated_channel(self, channel_idx, max_points=None):
-        values = list(self.logger.channels[channel_idx])[::DataLogger.ADC_BLOCK]
+        # one point per frame (IMU values repeat within it), as a view of the ring
+        values = self.logger.channel_view(channel_idx)[::DataLogger.ADC_BLOCK]
         if max_points is not None and len(values) > max_points:
             step = max(1, len(values) // max_points)
             values = values[::step]
-        x_values = list(range(len(values)))
-        return x_values, values
+        return np.arange(len(values)), values
 
     def _on_close(self):
         if self.saving:
@@ -0,0 +1,143 @@
+// daq_decoder_py.cpp
+// pybind11 module daq_decoder: FrameDecoder for DataLogger and notebooks.
+//
+//   dec = daq_decoder.Decoder()
+//   index, values = dec.feed(chunk)   # uint32[n], float32[n, ROW_VALUES]
+//
+// feed() decodes into buffers it allocates and hands them to numpy as they are
+// (no copy); decode_into() fills caller-owned arrays. The GIL is released while
+// decoding. A Decoder is not thread-safe: use one per reader thread.
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+#include <algorithm>
+#include <memory>
+
+#include "frame_decoder.h"
+
+namespace py = pybind11;
+
+constexpr size_t FEED_CHUNK_ROWS = 4096;  // initial feed() allocation, doubled as needed
+
+// Storage behind the two arrays feed() returns; freed with the last of them.
+struct RowBuffer {
+  std::vector<uint32_t> index;
+  std::vector<float> values;
+};
+
+static size_t feedInto(FrameDecoder& dec, RowBuffer& b, const uint8_t* data, size_t len) {
+  size_t rows = 0;
+  size_t cap = FEED_CHUNK_ROWS;
+  for (;;) {
+    b.index.resize(cap);
+    b.values.resize(cap * ROW_VALUES);
+    RowColumns out{b.index.data(), b.values.data(), cap, rows};
+    dec.decode(data, len, out);
+    rows = out.count;
+    if (!dec.outputFull()) return rows;
+    data = nullptr; // the rest is held by the decoder
+    len = 0;
+    cap *= 2;
+  }
+}
+
+static py::tuple feed(FrameDecoder& dec, py::buffer data) {
+  const py::buffer_info in = data.request();
+  if (in.ndim != 1 || in.itemsize != 1) throw py::value_error("feed() expects a bytes-like object");
+
+  auto b = std::make_unique<RowBuffer>();
+  size_t rows;
+  {
+    py::gil_scoped_release nogil;
+    rows = feedInto(dec, *b, (const uint8_t*)in.ptr, (size_t)in.size);
+  }
+
+  RowBuffer* raw = b.get();
+  py::capsule owner(raw, [](void* p) { delete (RowBuffer*)p; });
+  b.release();
+  py::array_t<uint32_t> index({rows}, {sizeof(uint32_t)}, raw->index.data(), owner);
+  py::array_t<float> values({rows, ROW_VALUES}, {ROW_VALUES * sizeof(float), sizeof(float)},
+                            raw->values.data(), owner);
+  return py::make_tuple(index, values);
+}
+
+static size_t decodeInto(FrameDecoder& dec, py::buffer data,
+                         py::array_t<uint32_t, py::array::c_style> index,
+                         py::array_t<float, py::array::c_style> values) {
+  const py::buffer_info in = data.request();
+  if (in.ndim != 1 || in.itemsize != 1) throw py::value_error("decode_into() expects a bytes-like object");
+  if (index.ndim() != 1 || values.ndim() != 2 || (size_t)values.shape(1) != ROW_VALUES) {
+    throw py::value_error("expected index uint32[n] and values float32[n, ROW_VALUES]");
+  }
+  const size_t cap = (size_t)std::min(index.shape(0), values.shape(0));
+  if (cap < PROFILE_MAX_BLOCK) throw py::value_error("arrays must hold at least one frame of rows");
+
+  RowColumns out{index.mutable_data(), values.mutable_data(), cap, 0};
+  py::gil_scoped_release nogil;
+  dec.decode((const uint8_t*)in.ptr, (size_t)in.size, out);
+  return out.count;
+}
+
+static py::object lastStats(const FrameDecoder& dec) {
+  const std::vector<uint8_t>& s = dec.lastStatsPacket();
+  if (s.empty()) return py::none();
+  return py::bytes((const char*)s.data(), s.size());
+}
+
+static py::list takeGaps(FrameDecoder& dec) {
+  py::list out;
+  for (const GapPacket& g : dec.takeGaps()) out.append(py::bytes((const char*)&g, sizeof(g)));
+  return out;
+}
+
+static py::list takeOrientation(FrameDecoder& dec) {
+  py::list out;
+  for (const OrientationPacket& o : dec.takeOrientation()) out.append(py::bytes((const char*)&o, sizeof(o)));
+  return out;
+}
+
+static py::list gapFrames(const FrameDecoder& dec) {
+  py::list out;
+  for (size_t r = 0; r < GAP_REASONS; r++) out.append(dec.stats().gapFrames[r]);
+  return out;
+}
+
+PYBIND11_MODULE(daq_decoder, m) {
+  m.doc() = "C++ decoder for the DAQ_System frame stream (DataLogger rows as numpy arrays)";
+  m.attr("ROW_VALUES") = ROW_VALUES;
+  m.attr("ADC_CH") = ADC_CH;
+  m.attr("IMU_CH") = IMU_CH;
+  m.attr("IMU_COUNT") = IMU_COUNT;
+  m.attr("PKT_VER") = PKT_VER;
+  m.attr("MIN_ROWS") = PROFILE_MAX_BLOCK;
+
+  py::class_<FrameDecoder>(m, "Decoder")
+    .def(py::init<>())
+    .def("feed", &feed, py::arg("data"),
+         "Decode a chunk of the stream; returns (index uint32[n], values float32[n, ROW_VALUES]).")
+    .def("decode_into", &decodeInto, py::arg("data"), py::arg("index").noconvert(),
+         py::arg("values").noconvert(),
+         "Decode into preallocated C-contiguous arrays; returns the row count. If they fill up "
+         "(output_full), the rest is held: call again with b'' to continue.")
+    .def("take_gaps", &takeGaps, "PKT_TYPE_GAP packets (bytes) received since the last call.")
+    .def("take_orientation", &takeOrientation,
+         "PKT_TYPE_ORIENTATION packets (bytes) received since the last call.")
+    .def("reset", &FrameDecoder::reset)
+    .def_property_readonly("output_full", &FrameDecoder::outputFull)
+    .def_property_readonly("held_bytes", &FrameDecoder::heldBytes)
+    .def_property_readonly("profile", &FrameDecoder::profile)
+    .def_property_readonly("last_stats_packet", &lastStats)
+    .def_property_readonly("bytes", [](const FrameDecoder& d) { return d.stats().bytes; })
+    .def_property_readonly("valid_frames", [](const FrameDecoder& d) { return d.stats().validFrames; })
+    .def_property_readonly("invalid_packets", [](const FrameDecoder& d) { return d.stats().invalidPackets; })
+    .def_property_readonly("lost_frames", [](const FrameDecoder& d) { return d.stats().lostFrames; })
+    .def_property_readonly("late_frames", [](const FrameDecoder& d) { return d.stats().lateFrames; })
+    .def_property_readonly("stats_packets", [](const FrameDecoder& d) { return d.stats().statsPackets; })
+    .def_property_readonly("orientation_packets", [](const FrameDecoder& d) { return d.stats().orientationPackets; })
+    .def_property_readonly("imu_repeated_frames", [](const FrameDecoder& d) { return d.stats().imuRepeatedFrames; })
+    .def_property_readonly("imu_skipped_samples", [](const FrameDecoder& d) { return d.stats().imuSkippedSamples; })
+    .def_property_readonly("adc_late_frames", [](const FrameDecoder& d) { return d.stats().adcLateFrames; })
+    .def_property_readonly("imu_late_frames", [](const FrameDecoder& d) { return d.stats().imuLateFrames; })
+    .def_property_readonly("gap_frames", &gapFrames);
+}
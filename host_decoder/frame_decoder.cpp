@@ -0,0 +1,379 @@
+#include "frame_decoder.h"
+
+#include <limits>
+#include <string.h>
+
+#include "crc16.h"
+
+// The firmware's instance lives in crc16.cpp (DRAM_ATTR); the host has its own.
+const Crc16Table CRC16_TABLE{};
+
+static constexpr uint8_t SYNC_LO = (uint8_t)(SYNC_WORD & 0xFF); // first byte on the wire
+static constexpr uint8_t SYNC_HI = (uint8_t)(SYNC_WORD >> 8);
+static constexpr float NAN_F = std::numeric_limits<float>::quiet_NaN();
+static constexpr uint64_t IMU_OMITTED_MASK = 1ull << COMPRESS_IMU_OMITTED_BIT;
+
+static_assert(sizeof(CompressedHeader::imu_mask) <= sizeof(uint64_t), "imu_mask read as one word");
+
+// ===================== Helpers =====================
+static inline uint16_t rd16(const uint8_t* p) {
+  uint16_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline uint32_t rd32(const uint8_t* p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static bool crcOk(const uint8_t* p, size_t len) {
+  return crc16_ccitt(p, len - sizeof(uint16_t)) == rd16(p + len - sizeof(uint16_t));
+}
+
+// First sync word in p[0..len), or nullptr. memchr does the wide search for
+// the first sync byte; the second byte is checked per candidate.
+static const uint8_t* findSync(const uint8_t* p, size_t len) {
+  const uint8_t* end = p + len;
+  while (end - p >= 2) {
+    p = (const uint8_t*)memchr(p, SYNC_LO, (size_t)(end - p) - 1);
+    if (p == nullptr) return nullptr;
+    if (p[1] == SYNC_HI) return p;
+    p++;
+  }
+  return nullptr;
+}
+
+// LSB-first reader over the compressed ADC bitstream; reads past the end give
+// zero bits (the length checks afterwards reject such a frame).
+class BitReader {
+public:
+  BitReader(const uint8_t* p, size_t bytes) : p_(p), bytes_(bytes) {}
+
+  uint32_t read(unsigned n) {
+    if (n == 0) return 0;
+    const size_t i = pos_ >> 3;
+    uint64_t w = 0;
+    if (i + sizeof(w) <= bytes_) {
+      memcpy(&w, p_ + i, sizeof(w));
+    } else {
+      for (size_t k = 0; i + k < bytes_; k++) w |= (uint64_t)p_[i + k] << (8 * k);
+    }
+    const uint32_t v = (uint32_t)(w >> (pos_ & 7)) & ((1u << n) - 1);
+    pos_ += n;
+    return v;
+  }
+
+  size_t bytesUsed() const { return (pos_ + 7) / 8; }
+
+private:
+  const uint8_t* p_;
+  size_t bytes_;
+  size_t pos_ = 0;
+};
+
+// Append block rows of ch ADC samples (row-major) and one IMU snapshot
+// (nullptr: degraded frame, NaN IMU values; fields not in imuValid are NaN too).
+template <class T>
+static void writeRows(RowColumns& out, uint32_t baseIdx, const T* adc, size_t ch, size_t block,
+                      const int16_t* imu, uint64_t imuValid = ~0ull) {
+  float imuVals[IMU_CH];
+  for (size_t k = 0; k < IMU_CH; k++) {
+    imuVals[k] = imu && ((imuValid >> k) & 1) ? (float)(imu[k] / (double)IMU_SCALE) : NAN_F;
+  }
+
+  for (size_t i = 0; i < block; i++) {
+    float* v = out.values + (out.count + i) * ROW_VALUES;
+    out.index[out.count + i] = baseIdx + (uint32_t)i;
+    for (size_t c = 0; c < ch; c++) v[c] = (float)adc[i * ch + c];
+    for (size_t c = ch; c < ADC_CH; c++) v[c] = NAN_F;
+    memcpy(v + ADC_CH, imuVals, sizeof(imuVals));
+  }
+  out.count += block;
+}
+
+// ===================== FrameDecoder =====================
+FrameDecoder::FrameDecoder() {
+  reset();
+}
+
+void FrameDecoder::reset() {
+  held_.clear();
+  lastStats_.clear();
+  gaps_.clear();
+  orient_.clear();
+  memset(&stats_, 0, sizeof(stats_));
+  memset(compressedImu_, 0, sizeof(compressedImu_));
+  compressedValid_ = 0;
+  compressedSeq_ = -1;
+  lastSeq_ = -1;
+  lastImuSeq_ = -1;
+  profile_ = PROFILE_BALANCED;
+  full_ = false;
+}
+
+std::vector<GapPacket> FrameDecoder::takeGaps() {
+  std::vector<GapPacket> g;
+  g.swap(gaps_);
+  return g;
+}
+
+std::vector<OrientationPacket> FrameDecoder::takeOrientation() {
+  std::vector<OrientationPacket> o;
+  o.swap(orient_);
+  return o;
+}
+
+size_t FrameDecoder::decode(const uint8_t* data, size_t len, RowColumns& out) {
+  const size_t before = out.count;
+  full_ = false;
+  stats_.bytes += len;
+
+  if (held_.empty()) {
+    // common case: decode in place, keep only the incomplete tail
+    const size_t used = scan(data, len, out);
+    held_.assign(data + used, data + len);
+  } else {
+    held_.insert(held_.end(), data, data + len);
+    const size_t used = scan(held_.data(), held_.size(), out);
+    held_.erase(held_.begin(), held_.begin() + used);
+  }
+  return out.count - before;
+}
+
+// Same resync rules as DataLogger._extract_packets: a packet that fails
+// validation costs one byte and the scan resumes at the next sync word.
+// Returns bytes consumed.
+size_t FrameDecoder::scan(const uint8_t* p, size_t len, RowColumns& out) {
+  size_t pos = 0;
+  while (len - pos >= 4) {
+    const uint8_t* s = findSync(p + pos, len - pos);
+    if (s == nullptr) {
+      pos = len - 1; // the last byte may be half a sync word
+      break;
+    }
+    pos = (size_t)(s - p);
+
+    bool invalid = false;
+    const size_t need = packetLength(p + pos, len - pos, invalid);
+    if (invalid) {
+      stats_.invalidPackets++;
+      pos++;
+      continue;
+    }
+    if (need == 0 || len - pos < need) break;
+
+    if (out.count + rowsIn(p + pos) > out.capacity) {
+      full_ = true;
+      break;
+    }
+
+    if (decodePacket(p + pos, need, out)) {
+      pos += need;
+    } else {
+      stats_.invalidPackets++;
+      pos++;
+    }
+  }
+  return pos;
+}
+
+// Length of the packet at p (a sync word), 0 if more bytes are needed to tell.
+size_t FrameDecoder::packetLength(const uint8_t* p, size_t avail, bool& invalid) const {
+  switch (p[3]) {
+    case PKT_TYPE_FRAME:
+      if (avail <= FRAME_PROFILE_OFFSET) return 0;
+      if (p[FRAME_PROFILE_OFFSET] >= PROFILE_COUNT) break;
+      return PROFILES[p[FRAME_PROFILE_OFFSET]].frameBytes;
+    case PKT_TYPE_FRAME_COMPRESSED: {
+      const size_t at = offsetof(CompressedHeader, len);
+      if (avail <= at) return 0;
+      if (p[at] < sizeof(CompressedHeader) + sizeof(uint16_t)) break;
+      return p[at];
+    }
+    case PKT_TYPE_STATS: {
+      const size_t at = offsetof(StatsPacket, len);
+      if (avail <= at) return 0;
+      if (p[at] != sizeof(StatsPacket)) break;
+      return sizeof(StatsPacket);
+    }
+    case PKT_TYPE_GAP:
+      return sizeof(GapPacket);
+    case PKT_TYPE_ORIENTATION:
+      return sizeof(OrientationPacket);
+    default:
+      break;
+  }
+  invalid = true;
+  return 0;
+}
+
+size_t FrameDecoder::rowsIn(const uint8_t* p) const {
+  if (p[3] != PKT_TYPE_FRAME && p[3] != PKT_TYPE_FRAME_COMPRESSED) return 0;
+  const uint8_t id = p[FRAME_PROFILE_OFFSET];
+  return id < PROFILE_COUNT ? PROFILES[id].adcBlock : 0;
+}
+
+bool FrameDecoder::decodePacket(const uint8_t* p, size_t len, RowColumns& out) {
+  if (p[2] != PKT_VER || !crcOk(p, len)) return false;
+
+  switch (p[3]) {
+    case PKT_TYPE_FRAME:
+      if (!decodeFrame(p, len, out)) return false;
+      break;
+    case PKT_TYPE_FRAME_COMPRESSED:
+      if (!decodeCompressed(p, len, out)) return false;
+      break;
+    case PKT_TYPE_STATS:
+      if (p[offsetof(StatsPacket, stage_count)] != STATS_STAGES) return false;
+      lastStats_.assign(p, p + len);
+      stats_.statsPackets++;
+      return true;
+    case PKT_TYPE_GAP:
+      return decodeGap(p, len);
+    case PKT_TYPE_ORIENTATION:
+      return decodeOrientation(p, len);
+    default:
+      return false;
+  }
+
+  stats_.validFrames++;
+  profile_ = p[FRAME_PROFILE_OFFSET];
+  const uint8_t flags = p[FRAME_FLAGS_OFFSET];
+  if (flags & FRAME_FLAG_ADC_LATE) stats_.adcLateFrames++;
+  if (flags & FRAME_FLAG_IMU_LATE) stats_.imuLateFrames++;
+  trackSeq(p);
+  return true;
+}
+
+// ---------------- Frames ----------------
+bool FrameDecoder::decodeFrame(const uint8_t* p, size_t len, RowColumns& out) {
+  bool ok = false;
+  withProfile(p[FRAME_PROFILE_OFFSET], [&](auto prof) {
+    using P = decltype(prof);
+    ProfilePacket<P> f;
+    if (len != sizeof(f)) return;
+    memcpy(&f, p, sizeof(f));
+    // aligned copies: the packed fields sit at odd offsets
+    uint16_t adc[P::ADC_BLOCK * P::ADC_CH];
+    int16_t imu[IMU_CH];
+    memcpy(adc, f.adc, sizeof(adc));
+    memcpy(imu, f.imu, sizeof(imu));
+    writeRows(out, f.adc_base_idx, adc, P::ADC_CH, P::ADC_BLOCK, imu);
+    ok = true;
+  });
+  return ok;
+}
+
+bool FrameDecoder::decodeCompressed(const uint8_t* p, size_t len, RowColumns& out) {
+  CompressedHeader h;
+  memcpy(&h, p, sizeof(h));
+  if (h.profile >= PROFILE_COUNT || h.len != len) return false;
+  const ProfileInfo& prof = PROFILES[h.profile];
+
+  const size_t payloadEnd = len - sizeof(uint16_t);
+  BitReader bits(p + sizeof(h), payloadEnd - sizeof(h));
+  int32_t adc[PROFILE_MAX_BLOCK * ADC_CH];
+  for (size_t c = 0; c < prof.adcCh; c++) {
+    int32_t v = (int32_t)bits.read(12);
+    const unsigned width = bits.read(4);
+    adc[c] = v;
+    for (size_t i = 1; i < prof.adcBlock; i++) {
+      const uint32_t zz = bits.read(width);
+      v += (int32_t)(zz >> 1) ^ -(int32_t)(zz & 1);
+      adc[i * prof.adcCh + c] = v;
+    }
+  }
+
+  size_t off = sizeof(h) + bits.bytesUsed();
+  uint64_t mask = 0;
+  for (size_t b = 0; b < sizeof(h.imu_mask); b++) mask |= (uint64_t)h.imu_mask[b] << (8 * b);
+
+  if (mask & IMU_OMITTED_MASK) {
+    if (off != payloadEnd) return false;
+    compressedValid_ = 0;
+    compressedSeq_ = h.frame_seq;
+    writeRows(out, h.adc_base_idx, adc, prof.adcCh, prof.adcBlock, nullptr);
+    return true;
+  }
+
+  // The encoder cannot see link loss: after any frame_seq discontinuity the
+  // omitted fields are unknown until a frame (the next keyframe at the latest)
+  // carries them again.
+  const bool follows = compressedSeq_ >= 0 && h.frame_seq == (uint32_t)compressedSeq_ + 1u;
+  uint64_t valid = follows ? compressedValid_ : 0;
+  int16_t imu[IMU_CH];
+  memcpy(imu, compressedImu_, sizeof(imu));
+  for (size_t i = 0; i < IMU_CH; i++) {
+    if (!(mask & (1ull << i))) continue;
+    if (off + sizeof(int16_t) > payloadEnd) return false;
+    imu[i] = (int16_t)rd16(p + off);
+    valid |= 1ull << i;
+    off += sizeof(int16_t);
+  }
+  if (off != payloadEnd) return false;
+
+  memcpy(compressedImu_, imu, sizeof(imu));
+  compressedValid_ = valid;
+  compressedSeq_ = h.frame_seq;
+  writeRows(out, h.adc_base_idx, adc, prof.adcCh, prof.adcBlock, imu, valid);
+  return true;
+}
+
+// ---------------- Gaps / loss ----------------
+bool FrameDecoder::decodeGap(const uint8_t* p, size_t len) {
+  GapPacket g;
+  if (len != sizeof(g)) return false;
+  memcpy(&g, p, sizeof(g));
+  stats_.gapFrames[g.reason < GAP_REASONS ? g.reason : 0] += g.count;
+  if (gaps_.size() >= GAP_KEEP) gaps_.erase(gaps_.begin());
+  gaps_.push_back(g);
+  return true;
+}
+
+bool FrameDecoder::decodeOrientation(const uint8_t* p, size_t len) {
+  OrientationPacket o;
+  if (len != sizeof(o)) return false;
+  memcpy(&o, p, sizeof(o));
+  stats_.orientationPackets++;
+  if (orient_.size() >= ORIENT_KEEP) orient_.erase(orient_.begin());
+  orient_.push_back(o);
+  return true;
+}
+
+// frame_seq is 32-bit and does not wrap in a session: a forward step is a gap,
+// anything else a late or duplicated frame (DataLogger._track_frame).
+void FrameDecoder::trackSeq(const uint8_t* p) {
+  const uint32_t seq = rd32(p + offsetof(FramePacket, frame_seq));
+  if (lastSeq_ >= 0) {
+    const uint32_t step = seq - (uint32_t)lastSeq_;
+    if (step == 0 || step >= 0x80000000u) {
+      stats_.lateFrames++;
+      return;
+    }
+    stats_.lostFrames += step - 1u;
+  }
+  lastSeq_ = seq;
+  trackImu(p);
+}
+
+// DataLogger._track_imu, without the capture-time log.
+void FrameDecoder::trackImu(const uint8_t* p) {
+  size_t at = offsetof(CompressedHeader, imu_seq);
+  if (p[3] == PKT_TYPE_FRAME) {
+    withProfile(p[FRAME_PROFILE_OFFSET], [&](auto prof) {
+      at = offsetof(ProfilePacket<decltype(prof)>, imu_seq);
+    });
+  }
+  const uint16_t imuSeq = rd16(p + at);
+  if (lastImuSeq_ >= 0) {
+    const uint16_t step = (uint16_t)(imuSeq - (uint16_t)lastImuSeq_);
+    if (step == 0) {
+      stats_.imuRepeatedFrames++;
+    } else if (step < 0x8000) {
+      stats_.imuSkippedSamples += step - 1u;
+    }
+  }
+  lastImuSeq_ = imuSeq;
+}
@@ -0,0 +1,106 @@
+// frame_decoder.h
+// Host-side decoder for the DAQ byte stream (serial, UDP datagrams or a
+// recording), built from the firmware's own packet headers so the layouts
+// cannot drift. Same behaviour as DataLogger's Python path: sync scan, CRC,
+// per-profile frames, compressed frames, gap, stats and orientation packets,
+// but it decodes
+// whole buffers straight into caller-provided columns.
+//
+// Rows match DataLogger rows: index = ADC sample index, values =
+// [adc x ADC_CH (NaN if the profile does not sample it), imu x IMU_CH / 100].
+
+#ifndef FRAME_DECODER_H
+#define FRAME_DECODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "daq_config.h"
+#include "frame_codec.h"
+#include "frame_packet.h"
+#include "profiles.h"
+
+constexpr size_t ROW_VALUES = ADC_CH + IMU_CH; // DataLogger.TOTAL_CHANNELS
+constexpr float  IMU_SCALE  = 100.0f;          // wire units -> physical
+constexpr size_t GAP_REASONS = 5;              // GapReason values + 1
+constexpr size_t GAP_KEEP    = 256;            // DataLogger.gaps length
+constexpr size_t ORIENT_KEEP = 256;            // orientation packets held between takeOrientation()
+
+// Preallocated output: index[capacity], values[capacity][ROW_VALUES].
+struct RowColumns {
+  uint32_t* index;
+  float*    values;
+  size_t    capacity;
+  size_t    count;
+};
+
+struct DecoderStats {
+  uint64_t bytes;            // bytes fed
+  uint32_t validFrames;      // type 1 + type 2
+  uint32_t invalidPackets;   // bad length / version / CRC (one resync step each)
+  uint32_t lostFrames;       // forward frame_seq gaps, device-side gaps included
+  uint32_t lateFrames;       // duplicate or out-of-order frame_seq
+  uint32_t imuRepeatedFrames; // imu_seq unchanged: IMU values repeat the previous frame
+  uint32_t imuSkippedSamples; // imu_seq steps > 1: IMU samples no frame carried
+  uint32_t adcLateFrames;    // FRAME_FLAG_ADC_LATE: a row missed its sampling deadline
+  uint32_t imuLateFrames;    // FRAME_FLAG_IMU_LATE: the IMU burst missed its deadline
+  uint32_t statsPackets;
+  uint32_t orientationPackets;
+  uint32_t gapFrames[GAP_REASONS]; // PKT_TYPE_GAP counts by GapReason, [0] = unknown reason
+};
+
+class FrameDecoder {
+public:
+  FrameDecoder();
+
+  // Decode data (after any bytes held from the previous call) into out,
+  // appending at out.count. Stops early when the next packet's rows would not
+  // fit; the rest is held, and outputFull() is true until a call with room
+  // (data may be empty) drains it. Returns rows written by this call.
+  size_t decode(const uint8_t* data, size_t len, RowColumns& out);
+
+  bool outputFull() const { return full_; }
+  size_t heldBytes() const { return held_.size(); }
+
+  const DecoderStats& stats() const { return stats_; }
+  uint8_t profile() const { return profile_; }
+
+  // Most recent PKT_TYPE_STATS packet, as sent (empty until one arrives).
+  const std::vector<uint8_t>& lastStatsPacket() const { return lastStats_; }
+
+  // PKT_TYPE_GAP packets received since the last call (at most GAP_KEEP).
+  std::vector<GapPacket> takeGaps();
+
+  // PKT_TYPE_ORIENTATION packets received since the last call (newest ORIENT_KEEP).
+  std::vector<OrientationPacket> takeOrientation();
+
+  void reset();
+
+private:
+  size_t scan(const uint8_t* p, size_t len, RowColumns& out);
+  size_t packetLength(const uint8_t* p, size_t avail, bool& invalid) const;
+  size_t rowsIn(const uint8_t* p) const;
+  bool decodePacket(const uint8_t* p, size_t len, RowColumns& out);
+  bool decodeFrame(const uint8_t* p, size_t len, RowColumns& out);
+  bool decodeCompressed(const uint8_t* p, size_t len, RowColumns& out);
+  bool decodeGap(const uint8_t* p, size_t len);
+  bool decodeOrientation(const uint8_t* p, size_t len);
+  void trackSeq(const uint8_t* p);
+  void trackImu(const uint8_t* p);
+
+  std::vector<uint8_t> held_;        // unconsumed tail of earlier input
+  std::vector<uint8_t> lastStats_;
+  std::vector<GapPacket> gaps_;
+  std::vector<OrientationPacket> orient_;
+  DecoderStats stats_;
+  int16_t compressedImu_[IMU_CH];    // omitted compressed fields keep these
+  uint64_t compressedValid_;         // bit i: compressedImu_[i] follows the encoder's state
+  int64_t compressedSeq_;            // frame_seq of the compressed frame it came from
+  int64_t lastSeq_;
+  int32_t lastImuSeq_;
+  uint8_t profile_;
+  bool full_;
+};
+
+#endif // FRAME_DECODER_H
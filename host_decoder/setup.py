@@ -0,0 +1,37 @@
+"""
+setup.py
+--------
+Builds the daq_decoder extension (C++ frame decoder, see frame_decoder.h) used
+by DataLogger(native_decoder=True):
+
+    pip install pybind11
+    pip install ./host_decoder
+
+The packet layouts come straight from the firmware headers in
+DAQ_System/include, so build from a full checkout. DataLogger falls back to its
+Python decoder when the module is not installed.
+"""
+
+import os
+
+from pybind11.setup_helpers import Pybind11Extension, build_ext
+from setuptools import setup
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+FIRMWARE_INCLUDE = os.path.join(HERE, "..", "DAQ_System", "include")
+
+setup(
+    name="daq_decoder",
+    version="0.1.0",
+    description="DAQ_System frame stream decoder with numpy output",
+    ext_modules=[
+        Pybind11Extension(
+            "daq_decoder",
+            ["daq_decoder_py.cpp", "frame_decoder.cpp"],
+            include_dirs=[HERE, FIRMWARE_INCLUDE],
+            cxx_std=17,
+        ),
+    ],
+    cmdclass={"build_ext": build_ext},
+    zip_safe=False,
+)